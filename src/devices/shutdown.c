@@ -4,8 +4,13 @@
 #include "devices/kbd.h"
 #include "devices/serial.h"
 #include "devices/timer.h"
+#include "threads/interrupt.h"
 #include "threads/io.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/slab.h"
 #include "threads/thread.h"
+#include "threads/trace.h"
 #ifdef USERPROG
 #include "userprog/exception.h"
 #endif
@@ -95,6 +100,9 @@ shutdown_power_off (void)
 #endif
 
   print_stats ();
+#ifdef SCHED_TRACE
+  trace_dump ();
+#endif
 
   printf ("Powering off...\n");
   serial_flush ();
@@ -129,7 +137,13 @@ static void
 print_stats (void)
 {
   timer_print_stats ();
+  intr_print_stats ();
   thread_print_stats ();
+  palloc_print_stats ();
+#ifdef ALLOC_STATS
+  malloc_print_stats ();
+#endif
+  slab_print_stats ();
 #ifdef FILESYS
   block_print_stats ();
 #endif
@@ -4,7 +4,10 @@
 #include <round.h>
 #include <stdio.h>
 #include "devices/pit.h"
+#include "threads/cpu.h"
 #include "threads/interrupt.h"
+#include "threads/ioapic.h"
+#include "threads/lapic.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
   
@@ -17,14 +20,61 @@
 #error TIMER_FREQ <= 1000 recommended
 #endif
 
-/* Number of timer ticks since OS booted. */
+/* Number of timer ticks since OS booted, and the sequence lock
+   that lets timer_ticks() read it with interrupts on. */
 static int64_t ticks;
+static struct seqlock ticks_seq;
+
+/* Dynamic ticks.
+
+   If true, the idle thread does not take a timer interrupt on
+   every tick.  Before it halts, timer_idle_enter() reprograms
+   the tick source as a one-shot timer that fires on the tick
+   boundary of the earliest sleeper's wake-up time.  The ticks
+   skipped this way are caught up, one at a time, when the
+   one-shot timer fires or, if some other interrupt wakes the CPU
+   first, when the idle thread resumes (timer_idle_exit()).
+   Controlled by kernel command-line option "-tickless". */
+bool timer_tickless;
+
+/* PIT cycles per timer tick. */
+#define TICK_CYCLES ((PIT_HZ + TIMER_FREQ / 2) / TIMER_FREQ)
+
+/* Tick source.
+
+   Timer ticks come from the 8254 PIT, or, once timer_calibrate()
+   has switched to it, from the local APIC timer, which is
+   programmed by memory-mapped writes instead of port I/O and
+   whose 32-bit counter lets a dynamic-tick one-shot timer run for
+   far longer.  The local APIC timer needs APIC mode (see
+   threads/interrupt.c), so the option turns that on too.
+   Controlled by kernel command-line option "-apictimer". */
+bool timer_lapic;
+static bool lapic_ticks;        /* Ticking from the local APIC timer? */
+
+/* Tick source cycles per timer tick, and the largest count its
+   one-shot timer accepts. */
+static uint32_t tick_cycles = TICK_CYCLES;
+static uint32_t max_count = UINT16_MAX;
+
+/* Number of ticks that will have passed when the armed one-shot
+   timer fires, or 0 if the PIT is in periodic mode. */
+static int oneshot_ticks;
 
 /* Number of loops per timer tick.
    Initialized by timer_calibrate(). */
 static unsigned loops_per_tick;
 
+/* Number of time-stamp counter cycles per timer tick.
+   Initialized by timer_calibrate(). */
+static uint64_t tsc_per_tick;
+
 static intr_handler_func timer_interrupt;
+static void start_lapic_timer (void);
+static void set_periodic (void);
+static void set_one_shot (uint32_t count);
+static uint32_t read_count (bool *expired);
+static void advance_ticks (int n);
 static bool too_many_loops (unsigned loops);
 static void busy_wait (int64_t loops);
 static void real_time_sleep (int64_t num, int32_t denom);
@@ -35,6 +85,7 @@ static void real_time_delay (int64_t num, int32_t denom);
 void
 timer_init (void) 
 {
+  seqlock_init (&ticks_seq);
   pit_configure_channel (0, 2, TIMER_FREQ);
   intr_register_ext (0x20, timer_interrupt, "8254 Timer");
 }
@@ -44,6 +95,8 @@ void
 timer_calibrate (void) 
 {
   unsigned high_bit, test_bit;
+  int64_t start;
+  uint64_t start_tsc;
 
   ASSERT (intr_get_level () == INTR_ON);
   printf ("Calibrating timer...  ");
@@ -64,15 +117,112 @@ timer_calibrate (void)
       loops_per_tick |= test_bit;
 
   printf ("%'"PRIu64" loops/s.\n", (uint64_t) loops_per_tick * TIMER_FREQ);
+
+  /* Time one whole tick with the time-stamp counter. */
+  start = timer_ticks ();
+  while (timer_ticks () == start)
+    continue;
+  start_tsc = rdtsc ();
+  while (timer_ticks () == start + 1)
+    continue;
+  tsc_per_tick = rdtsc () - start_tsc;
+
+  if (timer_lapic)
+    start_lapic_timer ();
+}
+
+/* Measures the rate of the local APIC timer against the PIT, then
+   takes timer ticks from the local APIC timer instead. */
+static void
+start_lapic_timer (void)
+{
+  enum intr_level old_level;
+  int64_t start;
+
+  if (!intr_apic_mode ())
+    {
+      printf ("No local APIC, using the PIT for timer ticks.\n");
+      return;
+    }
+
+  /* Count down through one whole tick, with the local APIC
+     timer's interrupt masked. */
+  start = timer_ticks ();
+  while (timer_ticks () == start)
+    continue;
+  lapic_timer_one_shot (0x20, UINT32_MAX, true);
+  while (timer_ticks () == start + 1)
+    continue;
+  tick_cycles = UINT32_MAX - lapic_timer_count ();
+
+  /* Switch just after a tick, so that no one-shot PIT timer is
+     armed. */
+  old_level = intr_disable ();
+  ioapic_mask (0, true);
+  lapic_ticks = true;
+  max_count = UINT32_MAX;
+  set_periodic ();
+  intr_set_level (old_level);
+
+  printf ("Using local APIC timer, %'"PRIu32" counts per tick.\n",
+          tick_cycles);
+}
+
+/* Makes the tick source interrupt once per tick. */
+static void
+set_periodic (void)
+{
+  if (lapic_ticks)
+    lapic_timer_periodic (0x20, tick_cycles);
+  else
+    pit_configure_channel (0, 2, TIMER_FREQ);
+}
+
+/* Makes the tick source interrupt once, after COUNT cycles. */
+static void
+set_one_shot (uint32_t count)
+{
+  if (lapic_ticks)
+    lapic_timer_one_shot (0x20, count, false);
+  else
+    pit_one_shot (0, count);
+}
+
+/* Returns the tick source's current count.  Stores in *EXPIRED
+   whether a one-shot count has run out. */
+static uint32_t
+read_count (bool *expired)
+{
+  uint32_t count;
+
+  if (!lapic_ticks)
+    return pit_read_count (0, expired);
+  count = lapic_timer_count ();
+  *expired = count == 0;
+  return count;
+}
+
+/* Returns the number of time-stamp counter cycles per timer
+   tick, or 0 before timer_calibrate() has run. */
+uint64_t
+timer_tsc_per_tick (void)
+{
+  return tsc_per_tick;
 }
 
 /* Returns the number of timer ticks since the OS booted. */
 int64_t
 timer_ticks (void) 
 {
-  enum intr_level old_level = intr_disable ();
-  int64_t t = ticks;
-  intr_set_level (old_level);
+  int64_t t;
+  unsigned seq;
+
+  do
+    {
+      seq = seqlock_read_begin (&ticks_seq);
+      t = ticks;
+    }
+  while (seqlock_read_retry (&ticks_seq, seq));
   return t;
 }
 
@@ -169,12 +319,104 @@ timer_print_stats (void)
 static void
 timer_interrupt (struct intr_frame *args UNUSED)
 {
-  ticks++;
-  thread_tick ();
-  //깨울 thread가 있는지 체크해서 thread_awake()호출
-  if(ticks>=get_next_tick_to_awake()){
-    thread_awake(timer_ticks());
-  }
+  int n = 1;
+
+  if (oneshot_ticks > 0)
+    {
+      n = oneshot_ticks;
+      oneshot_ticks = 0;
+      set_periodic ();
+    }
+  advance_ticks (n);
+}
+
+/* Counts N timer ticks, then wakes up the threads whose time has
+   come. */
+static void
+advance_ticks (int n)
+{
+  while (n-- > 0)
+    {
+      seqlock_write_begin (&ticks_seq);
+      ticks++;
+      seqlock_write_end (&ticks_seq);
+      thread_tick ();
+    }
+  if (ticks >= get_next_tick_to_awake ())
+    thread_awake (ticks);
+}
+
+/* Called by the idle thread, with interrupts off, just before it
+   halts the CPU.  In dynamic-tick mode, if no thread has to wake
+   up for at least two ticks, stops the periodic timer interrupt
+   and arms a one-shot timer for the tick boundary of the next
+   wake-up time instead.  The tick source's counter limits how
+   far ahead the one-shot timer may be set: about 55 ms for the
+   8254's 16-bit counter, much longer for the local APIC timer. */
+void
+timer_idle_enter (void)
+{
+  int64_t delta;
+  uint32_t first, max_ticks;
+  bool expired;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (!timer_tickless || oneshot_ticks > 0)
+    return;
+  delta = get_next_tick_to_awake () - ticks;
+  if (delta < 2)
+    return;
+
+  /* Cycles left until the end of the current tick. */
+  first = read_count (&expired);
+  if (first == 0 || first > tick_cycles)
+    first = tick_cycles;
+  max_ticks = 1 + (max_count - first) / tick_cycles;
+  if (delta > max_ticks)
+    delta = max_ticks;
+  if (delta < 2)
+    return;
+
+  set_one_shot (first + (delta - 1) * tick_cycles);
+
+  /* If the current tick ended while we were reprogramming the
+     tick source, its interrupt is pending.  Go back to periodic
+     mode and let it be handled as an ordinary tick. */
+  if (intr_is_pending (0x20))
+    {
+      set_periodic ();
+      return;
+    }
+  oneshot_ticks = delta;
+}
+
+/* Called by the idle thread, with interrupts off, after the CPU
+   wakes up and before it blocks again.  If a one-shot timer is
+   armed, catches up the ticks that have passed since it was
+   armed and rearms it for the end of the current tick, where
+   timer_interrupt() resumes periodic mode.  Does nothing if the
+   one-shot timer has already fired, because its pending
+   interrupt will catch up instead. */
+void
+timer_idle_exit (void)
+{
+  uint32_t left;
+  bool expired;
+  int passed;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (oneshot_ticks == 0)
+    return;
+  left = read_count (&expired);
+  if (expired || left == 0)
+    return;
+
+  passed = oneshot_ticks - DIV_ROUND_UP (left, tick_cycles);
+  set_one_shot ((left - 1) % tick_cycles + 1);
+  oneshot_ticks = 1;
+  advance_ticks (passed);
 }
 
 /* Returns true if LOOPS iterations waits for more than one timer
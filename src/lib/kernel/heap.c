@@ -0,0 +1,224 @@
+#include "heap.h"
+#include "../debug.h"
+
+/* A pairing heap is a tree in which every node is less than or
+   equal to its children.  Each node points to its leftmost child,
+   and the children of a node form a doubly linked list through
+   their `next' and `prev' members.  The `prev' member of a
+   leftmost child points to its parent instead, so that any node
+   can be unlinked in constant time.
+
+   Two heaps are merged by making the root with the greater value
+   the leftmost child of the other root.  Removing the root
+   leaves a list of subheaps, which are combined in two passes:
+   first pairwise from left to right, then into a single heap
+   from right to left.  The two-pass combination is what gives
+   the O(log n) amortized bound. */
+
+static struct heap_elem *merge (struct heap *, struct heap_elem *,
+                                struct heap_elem *);
+static struct heap_elem *combine_siblings (struct heap *,
+                                           struct heap_elem *);
+static struct heap_elem *parent (struct heap_elem *);
+
+/* Initializes HEAP as an empty heap ordered by LESS, which is
+   passed auxiliary data AUX. */
+void
+heap_init (struct heap *heap, heap_less_func *less, void *aux)
+{
+  ASSERT (heap != NULL);
+  ASSERT (less != NULL);
+
+  heap->root = NULL;
+  heap->size = 0;
+  heap->less = less;
+  heap->aux = aux;
+}
+
+/* Inserts ELEM into HEAP. */
+void
+heap_push (struct heap *heap, struct heap_elem *elem)
+{
+  ASSERT (heap != NULL);
+  ASSERT (elem != NULL);
+
+  elem->child = elem->next = elem->prev = NULL;
+  heap->root = heap->root != NULL ? merge (heap, heap->root, elem) : elem;
+  heap->size++;
+}
+
+/* Returns the least element in HEAP, which must not be empty. */
+struct heap_elem *
+heap_top (const struct heap *heap)
+{
+  ASSERT (!heap_empty (heap));
+  return heap->root;
+}
+
+/* Removes the least element from HEAP, which must not be empty,
+   and returns it. */
+struct heap_elem *
+heap_pop (struct heap *heap)
+{
+  struct heap_elem *top = heap_top (heap);
+
+  heap->root = combine_siblings (heap, top->child);
+  heap->size--;
+  return top;
+}
+
+/* Removes ELEM, which must be in HEAP, from HEAP. */
+void
+heap_remove (struct heap *heap, struct heap_elem *elem)
+{
+  struct heap_elem *sub;
+
+  ASSERT (heap != NULL);
+  ASSERT (elem != NULL);
+
+  if (elem == heap->root)
+    {
+      heap_pop (heap);
+      return;
+    }
+
+  /* Unlink ELEM, with its subtree, from its parent. */
+  ASSERT (elem->prev != NULL);
+  if (elem->prev->child == elem)
+    elem->prev->child = elem->next;
+  else
+    elem->prev->next = elem->next;
+  if (elem->next != NULL)
+    elem->next->prev = elem->prev;
+
+  /* Merge ELEM's children back in. */
+  sub = combine_siblings (heap, elem->child);
+  if (sub != NULL)
+    heap->root = merge (heap, heap->root, sub);
+  heap->size--;
+}
+
+/* Returns the number of elements in HEAP. */
+size_t
+heap_size (const struct heap *heap)
+{
+  ASSERT (heap != NULL);
+  return heap->size;
+}
+
+/* Returns true if HEAP is empty, false otherwise. */
+bool
+heap_empty (const struct heap *heap)
+{
+  ASSERT (heap != NULL);
+  return heap->root == NULL;
+}
+
+/* Calls ACTION for each element of HEAP, in no particular order,
+   passing it AUX.  ACTION must not modify HEAP. */
+void
+heap_apply (const struct heap *heap, heap_action_func *action, void *aux)
+{
+  struct heap_elem *e;
+
+  ASSERT (heap != NULL);
+  ASSERT (action != NULL);
+
+  /* Walk the tree in preorder without recursion: after each
+     element, descend to its leftmost child if it has one, and
+     otherwise move to the next sibling of the nearest ancestor
+     (or the element itself) that has one. */
+  e = heap->root;
+  while (e != NULL)
+    {
+      action (e, aux);
+      if (e->child != NULL)
+        e = e->child;
+      else
+        {
+          while (e != NULL && e->next == NULL)
+            e = parent (e);
+          if (e != NULL)
+            e = e->next;
+        }
+    }
+}
+
+/* Returns the parent of E, or a null pointer if E is the root. */
+static struct heap_elem *
+parent (struct heap_elem *e)
+{
+  while (e->prev != NULL && e->prev->child != e)
+    e = e->prev;
+  return e->prev;
+}
+
+/* Merges the heaps rooted at A and B, neither of which may have
+   siblings, and returns the root of the result. */
+static struct heap_elem *
+merge (struct heap *heap, struct heap_elem *a, struct heap_elem *b)
+{
+  if (heap->less (b, a, heap->aux))
+    {
+      struct heap_elem *tmp = a;
+      a = b;
+      b = tmp;
+    }
+
+  /* Make B the leftmost child of A. */
+  b->prev = a;
+  b->next = a->child;
+  if (a->child != NULL)
+    a->child->prev = b;
+  a->child = b;
+
+  a->next = a->prev = NULL;
+  return a;
+}
+
+/* Combines FIRST and its right siblings into a single heap and
+   returns its root, or a null pointer if FIRST is null. */
+static struct heap_elem *
+combine_siblings (struct heap *heap, struct heap_elem *first)
+{
+  struct heap_elem *pairs = NULL;
+  struct heap_elem *root;
+
+  /* First pass: merge pairs from left to right, building a list
+     of the results, linked through `next', in reverse order. */
+  while (first != NULL)
+    {
+      struct heap_elem *a = first;
+      struct heap_elem *b = a->next;
+
+      if (b != NULL)
+        {
+          first = b->next;
+          b->next = b->prev = NULL;
+          a->next = a->prev = NULL;
+          a = merge (heap, a, b);
+        }
+      else
+        first = NULL;
+
+      a->prev = NULL;
+      a->next = pairs;
+      pairs = a;
+    }
+
+  /* Second pass: merge the pairs from right to left. */
+  root = pairs;
+  if (root != NULL)
+    {
+      pairs = root->next;
+      root->next = NULL;
+      while (pairs != NULL)
+        {
+          struct heap_elem *next = pairs->next;
+          pairs->next = NULL;
+          root = merge (heap, root, pairs);
+          pairs = next;
+        }
+    }
+  return root;
+}
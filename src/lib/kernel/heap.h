@@ -0,0 +1,78 @@
+#ifndef __LIB_KERNEL_HEAP_H
+#define __LIB_KERNEL_HEAP_H
+
+/* Priority queue (pairing heap).
+
+   Like the list and hash table implementations, this heap does
+   not use dynamically allocated memory.  Each structure that can
+   potentially be in a heap must embed a struct heap_elem member,
+   and the heap_entry macro converts a struct heap_elem back to
+   the structure that contains it.  See lib/kernel/list.h for a
+   detailed explanation of the technique.
+
+   The heap is ordered by a caller-supplied "less" function.  The
+   top of the heap is its least element under that function, so
+   a comparison function that returns true when A's key is greater
+   than B's turns the heap into a max-heap.  Elements that
+   compare equal are returned in no particular order.
+
+   heap_push() and heap_top() take O(1) time.  heap_pop() and
+   heap_remove() take O(log n) amortized time, and heap_apply()
+   O(n) time.  None of the operations sleep or allocate, so a
+   heap may be used from an interrupt handler as long as it is
+   otherwise protected. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Heap element. */
+struct heap_elem
+  {
+    struct heap_elem *child;    /* Leftmost child. */
+    struct heap_elem *next;     /* Next sibling. */
+    struct heap_elem *prev;     /* Previous sibling, or parent if
+                                   this is the leftmost child. */
+  };
+
+/* Converts pointer to heap element HEAP_ELEM into a pointer to
+   the structure that HEAP_ELEM is embedded inside.  Supply the
+   name of the outer structure STRUCT and the member name MEMBER
+   of the heap element. */
+#define heap_entry(HEAP_ELEM, STRUCT, MEMBER)                   \
+        ((STRUCT *) ((uint8_t *) &(HEAP_ELEM)->child            \
+                     - offsetof (STRUCT, MEMBER.child)))
+
+/* Compares the value of two heap elements A and B, given
+   auxiliary data AUX.  Returns true if A is less than B, or
+   false if A is greater than or equal to B. */
+typedef bool heap_less_func (const struct heap_elem *a,
+                             const struct heap_elem *b,
+                             void *aux);
+
+/* Heap. */
+struct heap
+  {
+    struct heap_elem *root;     /* Least element, or null if empty. */
+    size_t size;                /* Number of elements. */
+    heap_less_func *less;       /* Comparison function. */
+    void *aux;                  /* Auxiliary data for `less'. */
+  };
+
+void heap_init (struct heap *, heap_less_func *, void *aux);
+
+void heap_push (struct heap *, struct heap_elem *);
+struct heap_elem *heap_top (const struct heap *);
+struct heap_elem *heap_pop (struct heap *);
+void heap_remove (struct heap *, struct heap_elem *);
+
+size_t heap_size (const struct heap *);
+bool heap_empty (const struct heap *);
+
+/* Performs some operation on heap element E, given auxiliary
+   data AUX. */
+typedef void heap_action_func (struct heap_elem *e, void *aux);
+
+void heap_apply (const struct heap *, heap_action_func *, void *aux);
+
+#endif /* lib/kernel/heap.h */
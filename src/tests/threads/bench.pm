@@ -0,0 +1,57 @@
+# -*- perl -*-
+use strict;
+use warnings;
+
+# Checks the output of a scheduler benchmark (see sched-bench.c).
+# Every bench line must consist of integer key=value pairs, and
+# every scheduler in @scheds must have reported a "bench $kind"
+# line with each set of keys in @{$required}.  A key whose value is
+# given in the set must have that value; a key whose value is undef
+# only has to be present.
+sub check_sched_bench {
+    my ($kind, $required) = @_;
+    our ($test);
+    my (@scheds) = ('rr', 'lottery', 'stride');
+    my ($name) = $test =~ m%([^/]+)$%;
+
+    my (@output) = read_text_file ("$test.output");
+    common_checks ("run", @output);
+    @output = get_core_output ("run", @output);
+    fail "missing PASS\n" if !grep (/^\($name\) PASS$/, @output);
+
+    my (@results);
+    foreach (@output) {
+	my ($line) = /^\($name\) bench (.*)$/ or next;
+	my ($got_kind, @pairs) = split (' ', $line);
+	fail "bench kind $got_kind, expected $kind: $_\n"
+	  if $got_kind ne $kind;
+	my (%result);
+	foreach my $pair (@pairs) {
+	    my ($key, $value) = $pair =~ /^(\w+)=(\w+)$/
+	      or fail "malformed bench result \"$pair\": $_\n";
+	    fail "non-integer bench result \"$pair\": $_\n"
+	      if $key ne 'sched' && $value !~ /^\d+$/;
+	    $result{$key} = $value;
+	}
+	push (@results, \%result);
+    }
+
+    foreach my $sched (@scheds) {
+	foreach my $want (@$required) {
+	    my ($found) = grep {
+		my ($r) = $_;
+		$r->{sched} eq $sched
+		  && !grep (!defined $r->{$_}
+			    || (defined $want->{$_} && $r->{$_} ne $want->{$_}),
+			    keys %$want);
+	    } @results;
+	    my ($desc) = join (' ', map ("$_=" . ($want->{$_} // '*'),
+					 sort keys %$want));
+	    fail "no bench $kind result for sched=$sched $desc\n"
+	      if !$found;
+	}
+    }
+    pass;
+}
+
+1;
@@ -0,0 +1,45 @@
+/* Checks admission control for real-time threads: reservations
+   are accepted while the total utilization stays within bounds,
+   rejected without effect once it would not, and released when a
+   thread goes back to best-effort scheduling. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func second_thread;
+static struct semaphore done;
+
+void
+test_edf_admission (void) 
+{
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  sema_init (&done, 0);
+
+  msg ("reserve 6 of 10 ticks: %s",
+       thread_set_realtime (6, 10) ? "admitted" : "rejected");
+  thread_create ("second", PRI_DEFAULT, second_thread, NULL);
+  sema_down (&done);
+
+  msg ("reserve 9 of 10 ticks: %s",
+       thread_set_realtime (9, 10) ? "admitted" : "rejected");
+  msg ("reserve 10 of 10 ticks: %s",
+       thread_set_realtime (10, 10) ? "admitted" : "rejected");
+  msg ("best-effort: %s",
+       thread_set_realtime (0, 0) ? "admitted" : "rejected");
+}
+
+static void
+second_thread (void *aux UNUSED) 
+{
+  msg ("second reserves 4 of 10 ticks: %s",
+       thread_set_realtime (4, 10) ? "admitted" : "rejected");
+  msg ("second reserves 30 of 100 ticks: %s",
+       thread_set_realtime (30, 100) ? "admitted" : "rejected");
+  thread_set_realtime (0, 0);
+  sema_up (&done);
+}
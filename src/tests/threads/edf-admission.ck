@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(edf-admission) begin
+(edf-admission) reserve 6 of 10 ticks: admitted
+(edf-admission) second reserves 4 of 10 ticks: rejected
+(edf-admission) second reserves 30 of 100 ticks: admitted
+(edf-admission) reserve 9 of 10 ticks: admitted
+(edf-admission) reserve 10 of 10 ticks: rejected
+(edf-admission) best-effort: admitted
+(edf-admission) end
+EOF
+pass;
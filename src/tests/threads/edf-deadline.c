@@ -0,0 +1,119 @@
+/* Runs a periodic real-time thread, which reserves RUNTIME ticks
+   in every 10 and does up to a tick of work at the start of each
+   period, against CPU-bound best-effort threads at the highest
+   priority.  Checks that the real-time thread always runs first
+   and finishes the work of every period within the period,
+   without a single deadline miss.  The thread reserves 2 ticks
+   per period first, then 1, with which the tick that ends its
+   work uses up its budget in every period; that is not a miss. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define PERIOD 10
+#define PERIOD_CNT 20
+#define SPIN_CNT 3
+
+/* Reservations to run, in ticks per period. */
+static const int runtimes[] = {2, 1};
+#define CASE_CNT (sizeof runtimes / sizeof *runtimes)
+
+static thread_func control_thread;
+static thread_func spin_thread;
+static struct semaphore started, finished;
+static volatile bool spinning;
+static int late_cnt[CASE_CNT];
+static unsigned miss_cnt[CASE_CNT];
+
+void
+test_edf_deadline (void) 
+{
+  size_t c;
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  sema_init (&started, 0);
+  sema_init (&finished, 0);
+  spinning = true;
+
+  /* The control thread becomes real-time before the spinning
+     threads, which would otherwise starve it, are created. */
+  thread_create ("control", PRI_MIN, control_thread, NULL);
+  sema_down (&started);
+  for (i = 0; i < SPIN_CNT; i++)
+    thread_create ("spin", PRI_MAX, spin_thread, NULL);
+
+  sema_down (&finished);
+  for (c = 0; c < CASE_CNT; c++)
+    {
+      msg ("runtime %d: %d periods finished late",
+           runtimes[c], late_cnt[c]);
+      msg ("runtime %d: %u deadlines missed", runtimes[c], miss_cnt[c]);
+    }
+}
+
+/* Returns the number of deadlines the running thread has
+   missed. */
+static unsigned
+deadline_misses (void) 
+{
+  struct thread_stats st;
+
+  if (!thread_get_stats (thread_tid (), &st))
+    fail ("no statistics for control thread");
+  return st.deadline_misses;
+}
+
+static void
+control_thread (void *aux UNUSED) 
+{
+  size_t c;
+
+  for (c = 0; c < CASE_CNT; c++)
+    {
+      unsigned misses;
+      int64_t start;
+      int i;
+
+      if (!thread_set_realtime (runtimes[c], PERIOD))
+        fail ("reservation rejected");
+      if (c == 0)
+        sema_up (&started);
+
+      misses = deadline_misses ();
+      start = timer_ticks () + 1;
+      for (i = 0; i < PERIOD_CNT; i++)
+        {
+          int64_t release_tick = start + i * PERIOD;
+          int64_t now;
+
+          timer_sleep (release_tick - timer_ticks ());
+
+          /* Work until the next tick. */
+          now = timer_ticks ();
+          while (timer_ticks () == now)
+            continue;
+
+          if (timer_ticks () >= release_tick + PERIOD)
+            late_cnt[c]++;
+        }
+      miss_cnt[c] = deadline_misses () - misses;
+    }
+
+  /* Stop the spinners. */
+  spinning = false;
+  sema_up (&finished);
+}
+
+static void
+spin_thread (void *aux UNUSED) 
+{
+  while (spinning)
+    continue;
+}
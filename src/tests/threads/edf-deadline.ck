@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(edf-deadline) begin
+(edf-deadline) runtime 2: 0 periods finished late
+(edf-deadline) runtime 2: 0 deadlines missed
+(edf-deadline) runtime 1: 0 periods finished late
+(edf-deadline) runtime 1: 0 deadlines missed
+(edf-deadline) end
+EOF
+pass;
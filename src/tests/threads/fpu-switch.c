@@ -0,0 +1,54 @@
+/* Checks that each thread keeps its own FPU registers across
+   thread switches.  Several threads each load a distinct value
+   onto the x87 register stack, yield to each other many times,
+   and then check that the value is still there. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+#define THREAD_CNT 4
+#define YIELD_CNT 20
+
+static thread_func fpu_thread;
+static struct semaphore done;
+static int wrong_cnt;
+
+void
+test_fpu_switch (void) 
+{
+  int i;
+
+  sema_init (&done, 0);
+  for (i = 0; i < THREAD_CNT; i++)
+    {
+      char name[16];
+      snprintf (name, sizeof name, "fpu %d", i);
+      thread_create (name, PRI_DEFAULT, fpu_thread, (void *) (i + 1000));
+    }
+  for (i = 0; i < THREAD_CNT; i++)
+    sema_down (&done);
+
+  if (wrong_cnt != 0)
+    fail ("%d threads lost their FPU state", wrong_cnt);
+  msg ("%d threads kept their FPU state", THREAD_CNT);
+}
+
+static void
+fpu_thread (void *value_) 
+{
+  int value = (int) value_;
+  int got;
+  int i;
+
+  asm volatile ("fildl %0" : : "m" (value));
+  for (i = 0; i < YIELD_CNT; i++)
+    thread_yield ();
+  asm volatile ("fistpl %0" : "=m" (got));
+
+  if (got != value)
+    wrong_cnt++;
+  sema_up (&done);
+}
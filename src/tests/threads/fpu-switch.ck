@@ -0,0 +1,10 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(fpu-switch) begin
+(fpu-switch) 4 threads kept their FPU state
+(fpu-switch) end
+EOF
+pass;
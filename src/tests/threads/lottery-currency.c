@@ -0,0 +1,64 @@
+/* The main thread, holding 1 lottery ticket, joins a currency
+   funded with 100 base tickets, and creates a higher-priority
+   member of the currency holding 3 tickets.  Checks that the
+   members' tickets are revalued as the other member blocks,
+   wakes up, and exits, and as the currency's funding changes. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/currency.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func member_thread_func;
+
+static struct semaphore member_sema;
+
+void
+test_lottery_currency (void) 
+{
+  static struct currency group;
+  tid_t main_tid = thread_tid ();
+  enum intr_level old_level;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  currency_init (&group, "group", NULL, 100);
+  old_level = intr_disable ();
+  currency_join (&group, thread_current ());
+  intr_set_level (old_level);
+  msg ("main alone: %d tickets", thread_get_tickets (main_tid));
+
+  sema_init (&member_sema, 0);
+  thread_create_lottery ("member", PRI_DEFAULT + 1, 3,
+                         member_thread_func, &main_tid);
+  msg ("member blocked: main %d tickets", thread_get_tickets (main_tid));
+
+  old_level = intr_disable ();
+  currency_set_funding (&group, 200);
+  intr_set_level (old_level);
+  msg ("funding doubled: main %d tickets", thread_get_tickets (main_tid));
+
+  sema_up (&member_sema);
+  msg ("member exited: main %d tickets", thread_get_tickets (main_tid));
+
+  old_level = intr_disable ();
+  currency_leave (thread_current ());
+  intr_set_level (old_level);
+  msg ("main left: %d tickets", thread_get_tickets (main_tid));
+}
+
+static void
+member_thread_func (void *main_tid_) 
+{
+  tid_t main_tid = *(tid_t *) main_tid_;
+
+  msg ("member: %d tickets, main %d tickets",
+       thread_get_tickets (thread_tid ()), thread_get_tickets (main_tid));
+  sema_down (&member_sema);
+  msg ("member: %d tickets, main %d tickets",
+       thread_get_tickets (thread_tid ()), thread_get_tickets (main_tid));
+}
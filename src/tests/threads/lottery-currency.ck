@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(lottery-currency) begin
+(lottery-currency) main alone: 100 tickets
+(lottery-currency) member: 75 tickets, main 25 tickets
+(lottery-currency) member blocked: main 100 tickets
+(lottery-currency) funding doubled: main 200 tickets
+(lottery-currency) member: 150 tickets, main 50 tickets
+(lottery-currency) member exited: main 200 tickets
+(lottery-currency) main left: 1 tickets
+(lottery-currency) end
+EOF
+pass;
@@ -0,0 +1,46 @@
+/* The main thread, holding 1 lottery ticket, acquires a lock.
+   Then it creates a higher-priority thread holding 100 tickets
+   that blocks acquiring the lock, transferring its tickets to
+   the main thread.  When the main thread releases the lock, the
+   transfer ends. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func acquire_thread_func;
+
+void
+test_lottery_transfer (void) 
+{
+  struct lock lock;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  lock_init (&lock);
+  lock_acquire (&lock);
+  msg ("Main thread should have 1 ticket.  Actual tickets: %d.",
+       thread_get_tickets (thread_tid ()));
+  thread_create_lottery ("acquire", PRI_DEFAULT + 1, 100,
+                         acquire_thread_func, &lock);
+  msg ("Main thread should have 101 tickets.  Actual tickets: %d.",
+       thread_get_tickets (thread_tid ()));
+  lock_release (&lock);
+  msg ("Main thread should have 1 ticket.  Actual tickets: %d.",
+       thread_get_tickets (thread_tid ()));
+}
+
+static void
+acquire_thread_func (void *lock_) 
+{
+  struct lock *lock = lock_;
+
+  lock_acquire (lock);
+  msg ("acquire: got the lock with %d tickets",
+       thread_get_tickets (thread_tid ()));
+  lock_release (lock);
+  msg ("acquire: done");
+}
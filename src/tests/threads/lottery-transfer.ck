@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(lottery-transfer) begin
+(lottery-transfer) Main thread should have 1 ticket.  Actual tickets: 1.
+(lottery-transfer) Main thread should have 101 tickets.  Actual tickets: 101.
+(lottery-transfer) acquire: got the lock with 100 tickets
+(lottery-transfer) acquire: done
+(lottery-transfer) Main thread should have 1 ticket.  Actual tickets: 1.
+(lottery-transfer) end
+EOF
+pass;
@@ -0,0 +1,182 @@
+/* Stress benchmark for malloc().  Runs a fixed, pseudo-random
+   sequence of mallocs and frees, mostly of small objects with
+   some up to a few pages, then grows a set of blocks step by
+   step with realloc(), and prints one result line
+
+     (TEST) bench malloc kind=size-class KEY=VALUE...
+
+   with integer values: the operations run and their throughput
+   in operations per million cycles, the mean cycles per malloc
+   and per free, the internal fragmentation of the allocations
+   (bytes set aside but not requested, in per mille of the bytes
+   set aside), and the number of reallocs and how many of them
+   kept the block in place.  The test fails only if a block is
+   overwritten or realloc() loses its contents. */
+
+#include <stdio.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/cpu.h"
+#include "threads/init.h"
+#include "threads/malloc.h"
+
+#define SLOT_CNT 256
+#define ROUNDS 20000
+
+/* Blocks grown by realloc(), and the size they grow to. */
+#define GROW_CNT 16
+#define GROW_MAX 16384
+
+/* An allocation that may be live. */
+struct slot
+  {
+    uint8_t *block;             /* Block, or null if free. */
+    size_t size;                /* Requested size. */
+  };
+
+static struct slot slots[SLOT_CNT];
+
+/* Linear congruential generator, so that every run sees the
+   same sequence. */
+static unsigned rand_state = 1;
+
+static unsigned
+next_rand (void)
+{
+  rand_state = rand_state * 1103515245 + 12345;
+  return (rand_state >> 16) & 0x7fff;
+}
+
+/* Returns the size of the next allocation: mostly up to 256
+   bytes, sometimes up to the largest size class, occasionally a
+   few pages. */
+static size_t
+next_size (void)
+{
+  unsigned r = next_rand () % 20;
+
+  if (r < 16)
+    return 1 + next_rand () % 256;
+  else if (r < 19)
+    return 257 + next_rand () % 1536;
+  else
+    return 1793 + next_rand () % 6400;
+}
+
+/* Fills BLOCK of SIZE bytes with TAG, or checks that it is still
+   filled with TAG. */
+static void
+tag_block (uint8_t *block, size_t size, uint8_t tag, bool check)
+{
+  size_t i;
+
+  if (!check)
+    memset (block, tag, size);
+  else
+    for (i = 0; i < size; i++)
+      if (block[i] != tag)
+        fail ("block %d byte %zu of %zu overwritten", tag, i, size);
+}
+
+/* Grows GROW_CNT blocks from 16 bytes to GROW_MAX bytes by half
+   again each step, checking that their contents survive.
+   Stores the number of reallocs into *REALLOCS and the number
+   that did not move the block into *IN_PLACE. */
+static void
+grow_blocks (unsigned *reallocs, unsigned *in_place)
+{
+  uint8_t *blocks[GROW_CNT];
+  size_t size = 16;
+  int i;
+
+  for (i = 0; i < GROW_CNT; i++)
+    {
+      blocks[i] = malloc (size);
+      if (blocks[i] == NULL)
+        fail ("malloc(%zu) failed", size);
+      tag_block (blocks[i], size, i, false);
+    }
+
+  while (size < GROW_MAX)
+    {
+      size_t new_size = size + size / 2;
+
+      for (i = 0; i < GROW_CNT; i++)
+        {
+          uint8_t *block = realloc (blocks[i], new_size);
+          if (block == NULL)
+            fail ("realloc(%zu) failed", new_size);
+          tag_block (block, size, i, true);
+          tag_block (block, new_size, i, false);
+          if (block == blocks[i])
+            (*in_place)++;
+          (*reallocs)++;
+          blocks[i] = block;
+        }
+      size = new_size;
+    }
+
+  for (i = 0; i < GROW_CNT; i++)
+    free (blocks[i]);
+}
+
+void
+test_malloc_bench (void)
+{
+  uint64_t malloc_total = 0, free_total = 0;
+  uint64_t requested = 0, reserved = 0;
+  unsigned mallocs = 0, frees = 0, reallocs = 0, in_place = 0;
+  int round, i;
+
+  for (round = 0; round < ROUNDS; round++)
+    {
+      struct slot *s = &slots[next_rand () % SLOT_CNT];
+      uint8_t tag = s - slots;
+      uint64_t start;
+
+      if (s->block != NULL)
+        {
+          tag_block (s->block, s->size, tag, true);
+          start = rdtsc ();
+          free (s->block);
+          free_total += rdtsc () - start;
+          s->block = NULL;
+          frees++;
+        }
+      else
+        {
+          s->size = next_size ();
+          start = rdtsc ();
+          s->block = malloc (s->size);
+          malloc_total += rdtsc () - start;
+          if (s->block == NULL)
+            fail ("malloc(%zu) failed", s->size);
+          tag_block (s->block, s->size, tag, false);
+          requested += s->size;
+          reserved += malloc_block_size (s->size);
+          mallocs++;
+        }
+    }
+
+  for (i = 0; i < SLOT_CNT; i++)
+    if (slots[i].block != NULL)
+      {
+        tag_block (slots[i].block, slots[i].size, i, true);
+        free (slots[i].block);
+        slots[i].block = NULL;
+      }
+
+  grow_blocks (&reallocs, &in_place);
+
+  msg ("bench malloc kind=size-class ops=%u ops_per_mcycle=%llu "
+       "malloc_mean=%llu free_mean=%llu frag=%llu reallocs=%u in_place=%u",
+       mallocs + frees,
+       (malloc_total + free_total
+        ? (mallocs + frees) * 1000000ULL / (malloc_total + free_total)
+        : 0),
+       mallocs ? malloc_total / mallocs : 0,
+       frees ? free_total / frees : 0,
+       reserved ? (reserved - requested) * 1000 / reserved : 0,
+       reallocs, in_place);
+  pass ();
+}
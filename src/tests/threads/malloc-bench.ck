@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+our ($test);
+
+my (@output) = read_text_file ("$test.output");
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+fail "missing PASS\n" if !grep (/^\(malloc-bench\) PASS$/, @output);
+fail "no bench result for kind=size-class\n"
+  if !grep (/^\(malloc-bench\) bench malloc kind=size-class( \w+=\d+)+$/, @output);
+pass;
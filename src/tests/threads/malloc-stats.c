@@ -0,0 +1,82 @@
+/* Checks the allocator statistics of a kernel built with
+   "make ALLOC_STATS=1": allocating and freeing blocks of one
+   size class moves its live and peak counts and its arena count
+   as expected, big blocks are counted in pages, and realloc() in
+   place keeps the counts straight.  Then prints the statistics,
+   as at power-off.  In other kernels, only says so. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/malloc.h"
+#include "threads/vaddr.h"
+
+#define BLOCK_SIZE 100
+#define BLOCK_CNT 200
+
+#ifdef ALLOC_STATS
+static void *blocks[BLOCK_CNT];
+
+void
+test_malloc_stats (void) 
+{
+  struct malloc_stats before, after;
+  void *big;
+  int i;
+
+  malloc_get_stats (BLOCK_SIZE, &before);
+  if (before.block_size != malloc_block_size (BLOCK_SIZE))
+    fail ("class of %d-byte blocks has %zu-byte blocks",
+          BLOCK_SIZE, before.block_size);
+
+  for (i = 0; i < BLOCK_CNT; i++)
+    {
+      blocks[i] = malloc (BLOCK_SIZE);
+      if (blocks[i] == NULL)
+        fail ("malloc failed");
+    }
+  malloc_get_stats (BLOCK_SIZE, &after);
+  if (after.live != before.live + BLOCK_CNT
+      || after.peak < after.live
+      || after.live_bytes != after.live * after.block_size
+      || after.allocs != before.allocs + BLOCK_CNT
+      || after.requested != before.requested + BLOCK_CNT * BLOCK_SIZE
+      || after.arenas * PGSIZE / after.block_size < after.live)
+    fail ("wrong counts after malloc: %zu live, %zu peak, %zu arenas",
+          after.live, after.peak, after.arenas);
+  msg ("malloc counted");
+
+  for (i = 0; i < BLOCK_CNT; i++)
+    free (blocks[i]);
+  malloc_get_stats (BLOCK_SIZE, &after);
+  if (after.live != before.live || after.peak < before.live + BLOCK_CNT)
+    fail ("wrong counts after free: %zu live, %zu peak",
+          after.live, after.peak);
+  msg ("free counted");
+
+  malloc_get_stats (4 * PGSIZE, &before);
+  big = malloc (2 * PGSIZE);
+  big = realloc (big, 3 * PGSIZE);
+  malloc_get_stats (4 * PGSIZE, &after);
+  if (big == NULL
+      || before.block_size != 0
+      || after.live != before.live + 1
+      || after.arenas != before.arenas + 4
+      || after.live_bytes != before.live_bytes + 4 * PGSIZE)
+    fail ("wrong big block counts: %zu live, %zu pages",
+          after.live, after.arenas);
+  free (big);
+  malloc_get_stats (4 * PGSIZE, &after);
+  if (after.live != before.live || after.arenas != before.arenas)
+    fail ("big block free not counted");
+  msg ("big blocks counted");
+
+  malloc_print_stats ();
+}
+#else
+void
+test_malloc_stats (void) 
+{
+  msg ("allocator statistics not built in");
+}
+#endif
@@ -0,0 +1,24 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+our ($test);
+
+my (@output) = read_text_file ("$test.output");
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+# Ignore the statistics that the test prints.
+@output = grep (/^\(malloc-stats\) /, @output);
+compare_output ("run", [<<'EOF', <<'EOF'], [@output]);
+(malloc-stats) begin
+(malloc-stats) malloc counted
+(malloc-stats) free counted
+(malloc-stats) big blocks counted
+(malloc-stats) end
+EOF
+(malloc-stats) begin
+(malloc-stats) allocator statistics not built in
+(malloc-stats) end
+EOF
+pass;
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+our ($test);
+
+my (@output) = read_text_file ("$test.output");
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+fail "missing PASS\n" if !grep (/^\(palloc-bench-bitmap\) PASS$/, @output);
+fail "no bench result for kind=bitmap\n"
+  if !grep (/^\(palloc-bench-bitmap\) bench palloc kind=bitmap( \w+=\d+)+$/, @output);
+pass;
@@ -0,0 +1,144 @@
+/* Stress benchmark for the page allocator.  Runs a fixed,
+   pseudo-random sequence of allocations and frees of 1 to 16
+   pages in the user pool, which the threads tests otherwise
+   leave alone, and prints one result line
+
+     (TEST) bench palloc kind=NAME KEY=VALUE...
+
+   with integer values: the mean and worst cycles per allocation
+   and per free, the number of allocations that failed, and, with
+   the allocations of the last round still live, the free pages
+   and the longest run of them, with the share of free pages
+   outside that run in per mille as a measure of fragmentation.
+   palloc-bench runs the buddy allocator, palloc-bench-bitmap
+   the first-fit bitmap scan.  The test fails only if the
+   allocator hands out overlapping or misaligned pages. */
+
+#include <stdio.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/cpu.h"
+#include "threads/init.h"
+#include "threads/palloc.h"
+#include "threads/vaddr.h"
+
+#define SLOT_CNT 64
+#define ROUNDS 4000
+
+/* An allocation that may be live. */
+struct slot
+  {
+    uint8_t *pages;             /* First page, or null if free. */
+    size_t page_cnt;            /* Number of pages. */
+  };
+
+static struct slot slots[SLOT_CNT];
+
+/* Linear congruential generator, so that every run and both
+   allocators see the same sequence. */
+static unsigned rand_state = 1;
+
+static unsigned
+next_rand (void) 
+{
+  rand_state = rand_state * 1103515245 + 12345;
+  return (rand_state >> 16) & 0x7fff;
+}
+
+/* Returns the size of the next allocation: mostly single pages,
+   sometimes a few, occasionally up to 16. */
+static size_t
+next_size (void) 
+{
+  unsigned r = next_rand () % 10;
+
+  if (r < 7)
+    return 1;
+  else if (r < 9)
+    return 2 + next_rand () % 3;
+  else
+    return 5 + next_rand () % 12;
+}
+
+/* Tags each page of S with its slot number, or checks that the
+   tags are still there. */
+static void
+tag_slot (const struct slot *s, bool check) 
+{
+  uint8_t tag = s - slots;
+  size_t i;
+
+  for (i = 0; i < s->page_cnt; i++)
+    if (!check)
+      s->pages[i * PGSIZE] = tag;
+    else if (s->pages[i * PGSIZE] != tag)
+      fail ("slot %d page %zu overwritten", tag, i);
+}
+
+void
+test_palloc_bench (void) 
+{
+  uint64_t alloc_total = 0, alloc_max = 0, free_total = 0, free_max = 0;
+  unsigned allocs = 0, frees = 0, failed = 0;
+  struct palloc_stats stats;
+  int round, i;
+
+  for (round = 0; round < ROUNDS; round++)
+    {
+      struct slot *s = &slots[next_rand () % SLOT_CNT];
+      uint64_t start, cycles;
+
+      if (s->pages != NULL)
+        {
+          tag_slot (s, true);
+          start = rdtsc ();
+          palloc_free_multiple (s->pages, s->page_cnt);
+          cycles = rdtsc () - start;
+          s->pages = NULL;
+          free_total += cycles;
+          if (cycles > free_max)
+            free_max = cycles;
+          frees++;
+        }
+      else
+        {
+          s->page_cnt = next_size ();
+          start = rdtsc ();
+          s->pages = palloc_get_multiple (PAL_USER, s->page_cnt);
+          cycles = rdtsc () - start;
+          if (s->pages == NULL)
+            {
+              failed++;
+              continue;
+            }
+          if (pg_ofs (s->pages) != 0)
+            fail ("misaligned allocation %p", s->pages);
+          tag_slot (s, false);
+          alloc_total += cycles;
+          if (cycles > alloc_max)
+            alloc_max = cycles;
+          allocs++;
+        }
+    }
+
+  palloc_get_stats (PAL_USER, &stats);
+  for (i = 0; i < SLOT_CNT; i++)
+    if (slots[i].pages != NULL)
+      {
+        tag_slot (&slots[i], true);
+        palloc_free_multiple (slots[i].pages, slots[i].page_cnt);
+        slots[i].pages = NULL;
+      }
+
+  msg ("bench palloc kind=%s allocs=%u alloc_mean=%llu alloc_max=%llu "
+       "frees=%u free_mean=%llu free_max=%llu failed=%u free_pages=%zu "
+       "largest_free=%zu frag=%zu",
+       palloc_bitmap ? "bitmap" : "buddy",
+       allocs, allocs ? alloc_total / allocs : 0, alloc_max,
+       frees, frees ? free_total / frees : 0, free_max, failed,
+       stats.free_cnt, stats.largest_free,
+       (stats.free_cnt
+        ? (stats.free_cnt - stats.largest_free) * 1000 / stats.free_cnt
+        : 0));
+  pass ();
+}
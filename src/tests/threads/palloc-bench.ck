@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+our ($test);
+
+my (@output) = read_text_file ("$test.output");
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+fail "missing PASS\n" if !grep (/^\(palloc-bench\) PASS$/, @output);
+fail "no bench result for kind=buddy\n"
+  if !grep (/^\(palloc-bench\) bench palloc kind=buddy( \w+=\d+)+$/, @output);
+pass;
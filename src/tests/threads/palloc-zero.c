@@ -0,0 +1,85 @@
+/* Checks the stock of pre-zeroed pages.  Lets the idle thread
+   fill the kernel pool's stock, then checks that PAL_ZERO pages
+   come from the stock while it lasts and are zeroed inline after
+   that, that both kinds are all zeros even if the pages were
+   dirty when last freed, and that the idle thread refills the
+   stock in the background. */
+
+#include <stdio.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/palloc.h"
+#include "threads/vaddr.h"
+#include "devices/timer.h"
+
+/* More pages than the stock holds. */
+#define PAGE_CNT 64
+
+static void *pages[PAGE_CNT];
+
+/* Allocates CNT PAL_ZERO pages, checks that they are zeroed and
+   fills them with garbage. */
+static void
+get_pages (int cnt) 
+{
+  int i;
+
+  for (i = 0; i < cnt; i++)
+    {
+      const uint8_t *p;
+
+      pages[i] = palloc_get_page (PAL_ZERO | PAL_ASSERT);
+      for (p = pages[i]; p < (uint8_t *) pages[i] + PGSIZE; p++)
+        if (*p != 0)
+          fail ("page %d byte %d is %#x", i, p - (uint8_t *) pages[i], *p);
+      memset (pages[i], 0xa5, PGSIZE);
+    }
+}
+
+static void
+free_pages (int cnt) 
+{
+  int i;
+
+  for (i = 0; i < cnt; i++)
+    palloc_free_page (pages[i]);
+}
+
+void
+test_palloc_zero (void) 
+{
+  struct palloc_stats before, after;
+
+  /* Pages are zeroed only while no thread is ready. */
+  timer_sleep (TIMER_FREQ / 10);
+  palloc_get_stats (0, &before);
+  if (before.zero_stock == 0)
+    fail ("stock empty after sleeping");
+
+  get_pages (1);
+  free_pages (1);
+  palloc_get_stats (0, &after);
+  if (after.zero_hits != before.zero_hits + 1)
+    fail ("page did not come from the stock");
+  msg ("stock pages are zeroed");
+
+  get_pages (PAGE_CNT);
+  free_pages (PAGE_CNT);
+  palloc_get_stats (0, &after);
+  if (after.zero_misses == before.zero_misses)
+    fail ("no page zeroed inline");
+  msg ("inline zeroing after stock runs out");
+
+  before = after;
+  timer_sleep (TIMER_FREQ / 10);
+  palloc_get_stats (0, &after);
+  if (after.zero_background == before.zero_background
+      || after.zero_stock == 0)
+    fail ("stock not refilled");
+  msg ("stock refilled in background");
+
+  get_pages (PAGE_CNT);
+  free_pages (PAGE_CNT);
+  msg ("recycled pages are zeroed");
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(palloc-zero) begin
+(palloc-zero) stock pages are zeroed
+(palloc-zero) inline zeroing after stock runs out
+(palloc-zero) stock refilled in background
+(palloc-zero) recycled pages are zeroed
+(palloc-zero) end
+EOF
+pass;
@@ -0,0 +1,46 @@
+/* Tests that, among threads of equal priority waiting on a
+   semaphore, the one with the most lottery tickets wakes up
+   first, and that threads with equal tickets wake up in the
+   order in which they started waiting. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func tickets_sema_thread;
+static struct semaphore sema;
+
+void
+test_priority_sema_tickets (void) 
+{
+  static const int tickets[] = {1, 5, 3, 5, 2};
+  int i;
+  
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  sema_init (&sema, 0);
+  thread_set_priority (PRI_MIN);
+  for (i = 0; i < 5; i++) 
+    {
+      char name[16];
+      snprintf (name, sizeof name, "tickets %d.%d", tickets[i], i);
+      thread_create_lottery (name, PRI_DEFAULT, tickets[i],
+                             tickets_sema_thread, NULL);
+    }
+
+  for (i = 0; i < 5; i++) 
+    {
+      sema_up (&sema);
+      msg ("Back in main thread."); 
+    }
+}
+
+static void
+tickets_sema_thread (void *aux UNUSED) 
+{
+  sema_down (&sema);
+  msg ("Thread %s woke up.", thread_name ());
+}
@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(priority-sema-tickets) begin
+(priority-sema-tickets) Thread tickets 5.1 woke up.
+(priority-sema-tickets) Back in main thread.
+(priority-sema-tickets) Thread tickets 5.3 woke up.
+(priority-sema-tickets) Back in main thread.
+(priority-sema-tickets) Thread tickets 3.2 woke up.
+(priority-sema-tickets) Back in main thread.
+(priority-sema-tickets) Thread tickets 2.4 woke up.
+(priority-sema-tickets) Back in main thread.
+(priority-sema-tickets) Thread tickets 1.0 woke up.
+(priority-sema-tickets) Back in main thread.
+(priority-sema-tickets) end
+EOF
+pass;
@@ -0,0 +1,194 @@
+/* Benchmarks read-mostly synchronization.  BENCH_THREADS threads
+   each run BENCH_OPS operations on a shared pair of counters,
+   one in WRITE_EVERY of them a write and the rest reads, under
+   each of a lock, a reader-writer lock with either policy, and a
+   sequence lock.  Each read and each lock-protected write yields
+   the CPU halfway through, standing in for a page fault or disk
+   wait in the critical section, so that readers can overlap
+   even on one CPU.  Prints one result line per kind of lock, in
+   the form
+
+     (rwlock-bench) bench rwlock kind=NAME KEY=VALUE...
+
+   with integer values: the mean cycles per operation, the most
+   readers seen in their critical sections at once, and, for the
+   sequence lock, the number of reads retried.  The test fails
+   only if a read sees an inconsistent pair. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/cpu.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+#define BENCH_THREADS 4
+#define BENCH_OPS 500
+#define WRITE_EVERY 16
+
+/* Kinds of lock to benchmark. */
+enum bench_kind
+  {
+    BENCH_LOCK,
+    BENCH_RW_WRITERS,
+    BENCH_RW_READERS,
+    BENCH_SEQLOCK
+  };
+
+static const char *kind_names[] =
+  {"lock", "rwlock-writers", "rwlock-readers", "seqlock"};
+#define KIND_CNT (sizeof kind_names / sizeof *kind_names)
+
+static enum bench_kind kind;
+static struct lock lock;
+static struct rwlock rw;
+static struct seqlock sl;
+static int a, b;
+static int readers_in, max_readers_in;
+static int retries;
+static struct semaphore done;
+
+/* Notes that a reader has entered its critical section. */
+static void
+enter_read (void) 
+{
+  enum intr_level old_level = intr_disable ();
+  if (++readers_in > max_readers_in)
+    max_readers_in = readers_in;
+  intr_set_level (old_level);
+}
+
+/* Notes that a reader has left its critical section. */
+static void
+exit_read (void) 
+{
+  enum intr_level old_level = intr_disable ();
+  readers_in--;
+  intr_set_level (old_level);
+}
+
+/* Reads the pair under the lock being benchmarked. */
+static void
+do_read (void) 
+{
+  int a_copy, b_copy;
+
+  if (kind == BENCH_SEQLOCK)
+    {
+      unsigned seq;
+
+      for (;;)
+        {
+          seq = seqlock_read_begin (&sl);
+          enter_read ();
+          a_copy = a;
+          thread_yield ();
+          b_copy = b;
+          exit_read ();
+          if (!seqlock_read_retry (&sl, seq))
+            break;
+          retries++;
+        }
+    }
+  else
+    {
+      if (kind == BENCH_LOCK)
+        lock_acquire (&lock);
+      else
+        rwlock_acquire_read (&rw);
+      enter_read ();
+      a_copy = a;
+      thread_yield ();
+      b_copy = b;
+      exit_read ();
+      if (kind == BENCH_LOCK)
+        lock_release (&lock);
+      else
+        rwlock_release_read (&rw);
+    }
+
+  if (a_copy != b_copy)
+    fail ("inconsistent read under %s: a=%d, b=%d",
+          kind_names[kind], a_copy, b_copy);
+}
+
+/* Updates the pair under the lock being benchmarked.  Writers
+   under a sequence lock run with interrupts off, so they cannot
+   yield. */
+static void
+do_write (void) 
+{
+  if (kind == BENCH_SEQLOCK)
+    {
+      enum intr_level old_level = intr_disable ();
+      seqlock_write_begin (&sl);
+      a++;
+      b++;
+      seqlock_write_end (&sl);
+      intr_set_level (old_level);
+      return;
+    }
+
+  if (kind == BENCH_LOCK)
+    lock_acquire (&lock);
+  else
+    rwlock_acquire_write (&rw);
+  a++;
+  thread_yield ();
+  b++;
+  if (kind == BENCH_LOCK)
+    lock_release (&lock);
+  else
+    rwlock_release_write (&rw);
+}
+
+static void
+bench_thread (void *id_) 
+{
+  int id = (int) id_;
+  int i;
+
+  for (i = 0; i < BENCH_OPS; i++)
+    if ((i + id) % WRITE_EVERY == 0)
+      do_write ();
+    else
+      do_read ();
+  sema_up (&done);
+}
+
+void
+test_rwlock_bench (void) 
+{
+  size_t k;
+
+  ASSERT (!thread_mlfqs);
+
+  for (k = 0; k < KIND_CNT; k++)
+    {
+      uint64_t start, cycles;
+      int i;
+
+      kind = k;
+      lock_init (&lock);
+      rwlock_init (&rw, (kind == BENCH_RW_READERS
+                         ? RWLOCK_PREFER_READERS : RWLOCK_PREFER_WRITERS));
+      seqlock_init (&sl);
+      sema_init (&done, 0);
+      a = b = 0;
+      readers_in = max_readers_in = 0;
+      retries = 0;
+
+      start = rdtsc ();
+      for (i = 0; i < BENCH_THREADS; i++)
+        thread_create ("bench", PRI_DEFAULT, bench_thread, (void *) i);
+      for (i = 0; i < BENCH_THREADS; i++)
+        sema_down (&done);
+      cycles = rdtsc () - start;
+
+      msg ("bench rwlock kind=%s threads=%d ops=%d mean=%llu overlap=%d "
+           "retries=%d", kind_names[k], BENCH_THREADS, BENCH_OPS,
+           cycles / (BENCH_THREADS * BENCH_OPS), max_readers_in, retries);
+    }
+  pass ();
+}
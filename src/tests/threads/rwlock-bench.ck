@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+our ($test);
+
+my (@output) = read_text_file ("$test.output");
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+fail "missing PASS\n" if !grep (/^\(rwlock-bench\) PASS$/, @output);
+
+# Every kind of lock must have reported a result line with
+# integer values.
+foreach my $kind ('lock', 'rwlock-writers', 'rwlock-readers', 'seqlock') {
+    fail "no bench result for kind=$kind\n"
+      if !grep (/^\(rwlock-bench\) bench rwlock kind=\Q$kind\E
+		 (\ \w+=\d+)+$/x, @output);
+}
+pass;
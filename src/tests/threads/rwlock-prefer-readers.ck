@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rwlock-prefer-readers) begin
+(rwlock-prefer-readers) main releasing
+(rwlock-prefer-readers) reader 1 reading
+(rwlock-prefer-readers) reader 2 reading
+(rwlock-prefer-readers) writer writing
+(rwlock-prefer-readers) end
+EOF
+pass;
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rwlock-prefer-writers) begin
+(rwlock-prefer-writers) main releasing
+(rwlock-prefer-writers) writer writing
+(rwlock-prefer-writers) reader 1 reading
+(rwlock-prefer-writers) reader 2 reading
+(rwlock-prefer-writers) end
+EOF
+pass;
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rwlock-readers) begin
+(rwlock-readers) main reading
+(rwlock-readers) reader 1 reading
+(rwlock-readers) reader 2 reading
+(rwlock-readers) reader 3 reading
+(rwlock-readers) main releasing
+(rwlock-readers) writer writing
+(rwlock-readers) end
+EOF
+pass;
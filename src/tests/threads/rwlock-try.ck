@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rwlock-try) begin
+(rwlock-try) holder has the internal lock
+(rwlock-try) both tries failed without waiting
+(rwlock-try) tries on the free lock behaved
+(rwlock-try) end
+EOF
+pass;
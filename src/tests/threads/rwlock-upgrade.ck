@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rwlock-upgrade) begin
+(rwlock-upgrade) main reading
+(rwlock-upgrade) upgrader reading
+(rwlock-upgrade) second upgrade refused
+(rwlock-upgrade) main releasing
+(rwlock-upgrade) upgrader writing
+(rwlock-upgrade) upgrader reading again
+(rwlock-upgrade) writer writing
+(rwlock-upgrade) reader reading
+(rwlock-upgrade) end
+EOF
+pass;
@@ -0,0 +1,216 @@
+/* Tests reader-writer locks.
+
+   rwlock-readers: several readers hold the lock at once, and a
+   writer gets it only after the last of them leaves.
+
+   rwlock-prefer-writers, rwlock-prefer-readers: when a writer
+   releases the lock while both readers and a writer wait, the
+   policy decides which side goes first.
+
+   rwlock-upgrade: a reader upgrades to writer ahead of a waiting
+   writer, a second upgrade that would deadlock is refused, and a
+   downgrade keeps the lock held for reading.
+
+   rwlock-try: the try variants fail at once, instead of waiting,
+   while another thread is inside an rwlock function on the same
+   lock, and otherwise succeed or fail according to who holds
+   it. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static struct rwlock rw;
+static struct semaphore go;
+static struct semaphore done;
+
+/* Creates a thread named NAME that runs FUNCTION at a priority
+   higher than the main thread's, so that it runs at once until
+   it blocks. */
+static void
+start_thread (const char *name, thread_func *function)
+{
+  thread_create (name, PRI_DEFAULT + 1, function, NULL);
+}
+
+/* Holds RW for reading until GO is raised. */
+static void
+slow_reader (void *aux UNUSED) 
+{
+  rwlock_acquire_read (&rw);
+  msg ("%s reading", thread_name ());
+  sema_down (&go);
+  rwlock_release_read (&rw);
+  sema_up (&done);
+}
+
+/* Holds RW briefly for reading. */
+static void
+reader (void *aux UNUSED) 
+{
+  rwlock_acquire_read (&rw);
+  msg ("%s reading", thread_name ());
+  rwlock_release_read (&rw);
+  sema_up (&done);
+}
+
+/* Holds RW briefly for writing. */
+static void
+writer (void *aux UNUSED) 
+{
+  rwlock_acquire_write (&rw);
+  msg ("%s writing", thread_name ());
+  rwlock_release_write (&rw);
+  sema_up (&done);
+}
+
+void
+test_rwlock_readers (void) 
+{
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  rwlock_init (&rw, RWLOCK_PREFER_WRITERS);
+  sema_init (&go, 0);
+  sema_init (&done, 0);
+
+  rwlock_acquire_read (&rw);
+  msg ("main reading");
+  start_thread ("reader 1", slow_reader);
+  start_thread ("reader 2", slow_reader);
+  start_thread ("reader 3", slow_reader);
+  start_thread ("writer", writer);
+
+  msg ("main releasing");
+  rwlock_release_read (&rw);
+  for (i = 0; i < 3; i++)
+    sema_up (&go);
+  for (i = 0; i < 4; i++)
+    sema_down (&done);
+}
+
+/* Releases RW, held for writing, to two waiting readers and a
+   waiting writer, under POLICY. */
+static void
+test_policy (enum rwlock_policy policy) 
+{
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  rwlock_init (&rw, policy);
+  sema_init (&done, 0);
+
+  rwlock_acquire_write (&rw);
+  start_thread ("reader 1", reader);
+  start_thread ("writer", writer);
+  start_thread ("reader 2", reader);
+
+  msg ("main releasing");
+  rwlock_release_write (&rw);
+  for (i = 0; i < 3; i++)
+    sema_down (&done);
+}
+
+void
+test_rwlock_prefer_writers (void) 
+{
+  test_policy (RWLOCK_PREFER_WRITERS);
+}
+
+void
+test_rwlock_prefer_readers (void) 
+{
+  test_policy (RWLOCK_PREFER_READERS);
+}
+
+/* Reads, upgrades, writes, downgrades, reads again. */
+static void
+upgrader (void *aux UNUSED) 
+{
+  rwlock_acquire_read (&rw);
+  msg ("upgrader reading");
+  if (!rwlock_upgrade (&rw))
+    fail ("upgrade refused");
+  msg ("upgrader writing");
+  rwlock_downgrade (&rw);
+  msg ("upgrader reading again");
+  rwlock_release_read (&rw);
+  sema_up (&done);
+}
+
+void
+test_rwlock_upgrade (void) 
+{
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  rwlock_init (&rw, RWLOCK_PREFER_WRITERS);
+  sema_init (&done, 0);
+
+  rwlock_acquire_read (&rw);
+  msg ("main reading");
+  start_thread ("upgrader", upgrader);
+  start_thread ("writer", writer);
+  start_thread ("reader", reader);
+
+  if (!rwlock_upgrade (&rw))
+    msg ("second upgrade refused");
+  else
+    fail ("second upgrade allowed");
+  msg ("main releasing");
+  rwlock_release_read (&rw);
+  for (i = 0; i < 3; i++)
+    sema_down (&done);
+}
+
+/* Holds RW's internal lock, as a thread part way through one of
+   the rwlock functions would, until GO is raised. */
+static void
+internal_holder (void *aux UNUSED) 
+{
+  lock_acquire (&rw.lock);
+  msg ("holder has the internal lock");
+  sema_down (&go);
+  lock_release (&rw.lock);
+  sema_up (&done);
+}
+
+void
+test_rwlock_try (void) 
+{
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  rwlock_init (&rw, RWLOCK_PREFER_WRITERS);
+  sema_init (&go, 0);
+  sema_init (&done, 0);
+
+  start_thread ("holder", internal_holder);
+  if (rwlock_try_acquire_read (&rw))
+    fail ("read acquired while the internal lock is held");
+  if (rwlock_try_acquire_write (&rw))
+    fail ("write acquired while the internal lock is held");
+  msg ("both tries failed without waiting");
+  sema_up (&go);
+  sema_down (&done);
+
+  if (!rwlock_try_acquire_read (&rw))
+    fail ("read refused on a free lock");
+  if (rwlock_try_acquire_write (&rw))
+    fail ("write acquired while reading");
+  rwlock_release_read (&rw);
+  if (!rwlock_try_acquire_write (&rw))
+    fail ("write refused on a free lock");
+  if (rwlock_try_acquire_read (&rw))
+    fail ("read acquired while writing");
+  rwlock_release_write (&rw);
+  msg ("tries on the free lock behaved");
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::threads::bench;
+
+# Queues of up to 256 threads always fit in memory; longer ones
+# may be skipped.
+check_sched_bench ('pick',
+		   [(map ({ready => $_, rounds => 512, mean => undef},
+			  1, 2, 4, 8, 16, 32, 64, 128, 256)),
+		    (map ({ready => $_}, 512, 1024, 2048, 4096))]);
@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::threads::bench;
+check_sched_bench ('share',
+		   [{thread => 0, tickets => 30, observed => undef},
+		    {thread => 1, tickets => 20, observed => undef},
+		    {thread => 2, tickets => 10, observed => undef},
+		    {quanta => undef, max_error => undef,
+		     chi2_milli => undef}]);
@@ -0,0 +1,476 @@
+/* Scheduler benchmarks.  Each test runs under every scheduler
+   that can be selected at runtime and prints one result line per
+   measurement, in the form
+
+     (TEST) bench KIND sched=NAME KEY=VALUE...
+
+   with integer values only, so that results can be collected
+   with a regular expression and compared between builds.  Times
+   are in time-stamp counter cycles.  The tests fail only if the
+   scheduler misbehaves, never because a number is too large.
+
+   sched-bench-switch: context-switch round trip between two
+   threads that hand a semaphore back and forth.
+
+   sched-bench-pick: latency of the scheduler class's pick_next
+   operation, which is all next_thread_to_run() does besides
+   bookkeeping, with 1 to 4096 threads in the ready queue.
+
+   sched-bench-wake: latency from a sleeping thread's wake-up to
+   its first instruction, under load from CPU-bound threads.
+
+   sched-bench-share: proportional-share error of CPU-bound
+   threads holding 30, 20 and 10 tickets, against the share each
+   scheduler promises.
+
+   sched-bench-churn: cost of creating a thread, running it and
+   reaping it, for short-lived threads created one after another. */
+
+#include <stdio.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/cpu.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/sched.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "devices/timer.h"
+
+/* Schedulers to benchmark. */
+struct bench_sched
+  {
+    const char *name;
+    enum scheduler_type type;
+    const struct sched_class *class;
+  };
+
+static const struct bench_sched scheds[] =
+  {
+    {"rr", SCHED_ROUND_ROBIN, &sched_rr},
+    {"lottery", SCHED_LOTTERY, &sched_lottery},
+    {"stride", SCHED_STRIDE, &sched_stride},
+  };
+#define SCHED_CNT (sizeof scheds / sizeof *scheds)
+
+/* Returns 1000 * PART / WHOLE, or 0 if WHOLE is 0. */
+static unsigned long long
+per_mille (uint64_t part, uint64_t whole)
+{
+  return whole != 0 ? part * 1000 / whole : 0;
+}
+
+/* Returns the cycle count at the low end of the thread_stats
+   histogram bucket that holds the Nth smallest of the intervals
+   counted in HIST, or 0 if HIST is empty. */
+static unsigned long long
+hist_percentile (const uint16_t hist[THREAD_HIST_BUCKETS], unsigned n)
+{
+  unsigned seen = 0;
+  int i;
+
+  for (i = 0; i < THREAD_HIST_BUCKETS; i++)
+    {
+      seen += hist[i];
+      if (seen > n)
+        return (unsigned long long) 1 << (i + THREAD_HIST_SHIFT);
+    }
+  return 0;
+}
+
+/* Context-switch round trip. */
+
+#define SWITCH_ROUNDS 1000
+
+static struct semaphore ping, pong;
+static struct semaphore exited;
+
+static void
+pong_thread (void *aux UNUSED)
+{
+  int i;
+
+  for (i = 0; i < SWITCH_ROUNDS; i++)
+    {
+      sema_down (&ping);
+      sema_up (&pong);
+    }
+  sema_up (&exited);
+}
+
+void
+test_sched_bench_switch (void)
+{
+  size_t s;
+
+  ASSERT (!thread_mlfqs);
+
+  for (s = 0; s < SCHED_CNT; s++)
+    {
+      uint64_t total = 0, min = UINT64_MAX;
+      int i;
+
+      set_scheduler (scheds[s].type);
+      sema_init (&ping, 0);
+      sema_init (&pong, 0);
+      sema_init (&exited, 0);
+      thread_create ("pong", PRI_DEFAULT, pong_thread, NULL);
+
+      /* Each round trip switches to the pong thread when we block
+         on PONG, and back when it blocks on PING. */
+      for (i = 0; i < SWITCH_ROUNDS; i++)
+        {
+          uint64_t start = rdtsc ();
+          uint64_t cycles;
+
+          sema_up (&ping);
+          sema_down (&pong);
+          cycles = rdtsc () - start;
+          total += cycles;
+          if (cycles < min)
+            min = cycles;
+        }
+      sema_down (&exited);
+
+      msg ("bench switch sched=%s rounds=%d min=%llu mean=%llu",
+           scheds[s].name, SWITCH_ROUNDS, min, total / SWITCH_ROUNDS);
+    }
+  set_scheduler (SCHED_ROUND_ROBIN);
+  pass ();
+}
+
+/* Pick latency. */
+
+#define PICK_MAX 4096
+#define PICK_ROUNDS 512
+#define PICK_TID_BASE 0x40000000
+#define THREADS_PER_PAGE (PGSIZE / sizeof (struct thread))
+
+/* Allocates up to PICK_MAX blank threads into FAKE, a page at a
+   time, and returns the number allocated.  The threads are never
+   run, only queued, so they need no stacks. */
+static int
+alloc_fake_threads (struct thread **fake)
+{
+  int cnt = 0;
+
+  while (cnt < PICK_MAX)
+    {
+      struct thread *page = palloc_get_page (PAL_ZERO);
+      size_t i;
+
+      if (page == NULL)
+        break;
+      for (i = 0; i < THREADS_PER_PAGE && cnt < PICK_MAX; i++)
+        fake[cnt++] = page + i;
+    }
+  return cnt;
+}
+
+/* Frees the threads allocated by alloc_fake_threads(). */
+static void
+free_fake_threads (struct thread **fake, int cnt)
+{
+  int i;
+
+  for (i = 0; i < cnt; i += THREADS_PER_PAGE)
+    palloc_free_page (fake[i]);
+}
+
+/* Readies the first LEN threads in FAKE under CLASS, then times
+   PICK_ROUNDS picks, each followed by requeuing the picked
+   thread so that the ready queue keeps its length, and returns
+   the total cycles.  Stores the fastest pick in *MIN. */
+static uint64_t
+time_picks (const struct sched_class *class, struct thread **fake, int len,
+            uint64_t *min)
+{
+  uint64_t total = 0;
+  int i;
+
+  for (i = 0; i < len; i++)
+    {
+      struct thread *t = fake[i];
+
+      memset (t, 0, sizeof *t);
+      t->tid = PICK_TID_BASE + i;
+      t->status = THREAD_READY;
+      t->priority = PRI_DEFAULT;
+      t->tickets = 1 + i % 100;
+      if (class->join != NULL)
+        class->join (t);
+      class->enqueue (t);
+    }
+
+  *min = UINT64_MAX;
+  for (i = 0; i < PICK_ROUNDS; i++)
+    {
+      uint64_t start = rdtsc ();
+      struct thread *t = class->pick_next ();
+      uint64_t cycles = rdtsc () - start;
+
+      ASSERT (t != NULL && t->tid >= PICK_TID_BASE);
+      total += cycles;
+      if (cycles < *min)
+        *min = cycles;
+      if (class->join != NULL)
+        class->join (t);
+      class->enqueue (t);
+    }
+
+  for (i = 0; i < len; i++)
+    ASSERT (class->pick_next () != NULL);
+  ASSERT (class->pick_next () == NULL);
+  return total;
+}
+
+void
+test_sched_bench_pick (void)
+{
+  struct thread **fake;
+  int fake_cnt;
+  size_t s;
+
+  ASSERT (!thread_mlfqs);
+
+  fake = malloc (PICK_MAX * sizeof *fake);
+  if (fake == NULL)
+    fail ("out of memory");
+  fake_cnt = alloc_fake_threads (fake);
+
+  /* With interrupts off and no other thread created yet, the
+     ready queues of all the classes are empty, so the benchmark
+     can drive them directly. */
+  for (s = 0; s < SCHED_CNT; s++)
+    {
+      int len;
+
+      for (len = 1; len <= PICK_MAX; len *= 2)
+        {
+          enum intr_level old_level;
+          uint64_t total, min;
+
+          if (len > fake_cnt)
+            {
+              msg ("bench pick sched=%s ready=%d skipped=1",
+                   scheds[s].name, len);
+              continue;
+            }
+
+          old_level = intr_disable ();
+          total = time_picks (scheds[s].class, fake, len, &min);
+          intr_set_level (old_level);
+
+          msg ("bench pick sched=%s ready=%d rounds=%d min=%llu mean=%llu",
+               scheds[s].name, len, PICK_ROUNDS, min, total / PICK_ROUNDS);
+        }
+    }
+
+  free_fake_threads (fake, fake_cnt);
+  free (fake);
+  pass ();
+}
+
+/* Wake-to-run latency. */
+
+#define WAKE_ROUNDS 100
+#define WAKE_LOAD_CNT 2
+
+static volatile bool loading;
+static struct semaphore slept, release;
+
+/* Burns CPU until LOADING becomes false. */
+static void
+spin_thread (void *aux UNUSED)
+{
+  while (loading)
+    continue;
+  sema_up (&exited);
+}
+
+static void
+sleep_thread (void *aux UNUSED)
+{
+  int i;
+
+  for (i = 0; i < WAKE_ROUNDS; i++)
+    timer_sleep (1);
+
+  /* Stay alive until our statistics have been read. */
+  sema_up (&slept);
+  sema_down (&release);
+}
+
+void
+test_sched_bench_wake (void)
+{
+  size_t s;
+
+  ASSERT (!thread_mlfqs);
+
+  for (s = 0; s < SCHED_CNT; s++)
+    {
+      struct thread_stats st;
+      tid_t tid;
+      int i;
+
+      set_scheduler (scheds[s].type);
+      sema_init (&slept, 0);
+      sema_init (&release, 0);
+      sema_init (&exited, 0);
+      loading = true;
+      for (i = 0; i < WAKE_LOAD_CNT; i++)
+        thread_create ("load", PRI_DEFAULT, spin_thread, NULL);
+      tid = thread_create ("sleeper", PRI_DEFAULT, sleep_thread, NULL);
+
+      sema_down (&slept);
+      if (!thread_get_stats (tid, &st) || st.schedules == 0)
+        fail ("no statistics for sleeper thread");
+      loading = false;
+      sema_up (&release);
+      for (i = 0; i < WAKE_LOAD_CNT; i++)
+        sema_down (&exited);
+
+      msg ("bench wake sched=%s wakeups=%u mean=%llu p50=%llu p99=%llu",
+           scheds[s].name, st.schedules, st.ready_cycles / st.schedules,
+           hist_percentile (st.ready_hist, st.schedules / 2),
+           hist_percentile (st.ready_hist, st.schedules * 99 / 100));
+    }
+  set_scheduler (SCHED_ROUND_ROBIN);
+  pass ();
+}
+
+/* Proportional-share error. */
+
+#define SHARE_CNT 3
+#define SHARE_TIME (3 * TIMER_FREQ)
+
+void
+test_sched_bench_share (void)
+{
+  static const int tickets[SHARE_CNT] = {30, 20, 10};
+  size_t s;
+
+  ASSERT (!thread_mlfqs);
+
+  for (s = 0; s < SCHED_CNT; s++)
+    {
+      struct thread_stats st[SHARE_CNT];
+      tid_t tids[SHARE_CNT];
+      uint64_t total_cycles = 0;
+      uint64_t total_quanta = 0;
+      uint64_t chi2_milli = 0;
+      int total_tickets = 0;
+      int max_error = 0;
+      int i;
+
+      set_scheduler (scheds[s].type);
+      sema_init (&exited, 0);
+      loading = true;
+      for (i = 0; i < SHARE_CNT; i++)
+        {
+          char name[16];
+          snprintf (name, sizeof name, "share %d", i);
+          tids[i] = thread_create_lottery (name, PRI_DEFAULT, tickets[i],
+                                           spin_thread, NULL);
+          total_tickets += tickets[i];
+        }
+
+      timer_sleep (SHARE_TIME);
+
+      /* Read the accounting while the threads are still alive. */
+      for (i = 0; i < SHARE_CNT; i++)
+        {
+          if (!thread_get_stats (tids[i], &st[i]))
+            fail ("no statistics for thread %d", i);
+          total_cycles += st[i].run_cycles;
+          total_quanta += st[i].schedules;
+        }
+      loading = false;
+      for (i = 0; i < SHARE_CNT; i++)
+        sema_down (&exited);
+
+      /* Round-robin ignores tickets and promises an equal share.
+         The chi-square statistic compares the number of quanta
+         each thread received against the expected number. */
+      for (i = 0; i < SHARE_CNT; i++)
+        {
+          int expected = (scheds[s].type == SCHED_ROUND_ROBIN
+                          ? 1000 / SHARE_CNT
+                          : 1000 * tickets[i] / total_tickets);
+          int observed = per_mille (st[i].run_cycles, total_cycles);
+          int error = observed > expected ? observed - expected
+                                          : expected - observed;
+          uint64_t expected_quanta = total_quanta * expected / 1000;
+
+          if (error > max_error)
+            max_error = error;
+          if (expected_quanta > 0)
+            {
+              int64_t diff = (int64_t) st[i].schedules - expected_quanta;
+              chi2_milli += diff * diff * 1000 / expected_quanta;
+            }
+          msg ("bench share sched=%s thread=%d tickets=%d expected=%d "
+               "observed=%d", scheds[s].name, i, tickets[i], expected,
+               observed);
+        }
+      msg ("bench share sched=%s quanta=%llu max_error=%d chi2_milli=%llu",
+           scheds[s].name, total_quanta, max_error, chi2_milli);
+    }
+  set_scheduler (SCHED_ROUND_ROBIN);
+  pass ();
+}
+
+/* Thread create/exit churn. */
+
+#define CHURN_ROUNDS 500
+
+static void
+churn_thread (void *aux UNUSED)
+{
+  sema_up (&exited);
+}
+
+void
+test_sched_bench_churn (void)
+{
+  size_t s;
+
+  ASSERT (!thread_mlfqs);
+
+  for (s = 0; s < SCHED_CNT; s++)
+    {
+      uint64_t total = 0, min = UINT64_MAX;
+      int i;
+
+      set_scheduler (scheds[s].type);
+      sema_init (&exited, 0);
+
+      /* Each round creates a thread and waits for it to run.  The
+         thread's page is freed on the switch back to us, so the
+         next round can reuse it. */
+      for (i = 0; i < CHURN_ROUNDS; i++)
+        {
+          uint64_t start = rdtsc ();
+          uint64_t cycles;
+
+          if (thread_create ("churn", PRI_DEFAULT, churn_thread, NULL)
+              == TID_ERROR)
+            fail ("thread_create failed");
+          sema_down (&exited);
+          thread_yield ();
+          cycles = rdtsc () - start;
+          total += cycles;
+          if (cycles < min)
+            min = cycles;
+        }
+
+      msg ("bench churn sched=%s rounds=%d min=%llu mean=%llu",
+           scheds[s].name, CHURN_ROUNDS, min, total / CHURN_ROUNDS);
+    }
+  set_scheduler (SCHED_ROUND_ROBIN);
+  pass ();
+}
@@ -0,0 +1,90 @@
+/* Tests sequence locks.  First checks that a reader is told to
+   retry exactly when a write intervened.  Then reads a pair of
+   counters, whose sum a higher-priority writer keeps at 0, while
+   the writer preempts the reader at timer ticks, and checks that
+   every read that was not retried saw a consistent pair. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define WRITES 50
+
+static struct seqlock sl;
+static int a, b;
+static volatile bool writes_done;
+static struct semaphore done;
+
+/* Updates A and B under SL, preserving A + B == 0. */
+static void
+write_pair (void) 
+{
+  enum intr_level old_level = intr_disable ();
+  seqlock_write_begin (&sl);
+  a++;
+  b--;
+  seqlock_write_end (&sl);
+  intr_set_level (old_level);
+}
+
+static void
+writer (void *aux UNUSED) 
+{
+  int i;
+
+  for (i = 0; i < WRITES; i++)
+    {
+      timer_sleep (1);
+      write_pair ();
+    }
+  writes_done = true;
+  sema_up (&done);
+}
+
+void
+test_seqlock (void) 
+{
+  unsigned seq;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  seqlock_init (&sl);
+  sema_init (&done, 0);
+
+  seq = seqlock_read_begin (&sl);
+  write_pair ();
+  if (!seqlock_read_retry (&sl, seq))
+    fail ("read not retried after a write");
+  seq = seqlock_read_begin (&sl);
+  if (seqlock_read_retry (&sl, seq))
+    fail ("read retried without a write");
+  msg ("retry detects writes");
+
+  thread_create ("writer", PRI_DEFAULT + 1, writer, NULL);
+  while (!writes_done)
+    {
+      int a_copy, b_copy;
+
+      do
+        {
+          int i;
+
+          seq = seqlock_read_begin (&sl);
+          a_copy = a;
+          for (i = 0; i < 1000; i++)
+            barrier ();
+          b_copy = b;
+        }
+      while (seqlock_read_retry (&sl, seq));
+
+      if (a_copy + b_copy != 0)
+        fail ("inconsistent read: a=%d, b=%d", a_copy, b_copy);
+    }
+  sema_down (&done);
+  msg ("all reads consistent");
+}
@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(seqlock) begin
+(seqlock) retry detects writes
+(seqlock) all reads consistent
+(seqlock) end
+EOF
+pass;
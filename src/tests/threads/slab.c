@@ -0,0 +1,117 @@
+/* Tests the slab allocator: objects are aligned and distinct,
+   the constructor runs once per object when its slab is created
+   and not again when a freed object is reused, successive slabs
+   are colored differently, and slab_shrink() gives the empty
+   slab the cache keeps back to the page allocator. */
+
+#include <stdio.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/slab.h"
+#include "threads/vaddr.h"
+
+/* 120-byte objects aligned on 8 bytes leave room for several
+   colors in each page. */
+#define OBJ_SIZE 120
+#define OBJ_ALIGN 8
+#define OBJ_CNT 100
+
+#define OBJ_MAGIC 0x0b1ec7
+
+struct obj
+  {
+    unsigned magic;
+    uint8_t data[OBJ_SIZE - sizeof (unsigned)];
+  };
+
+static struct slab_cache cache;
+static struct obj *objs[OBJ_CNT];
+static int ctor_cnt;
+
+static void
+obj_ctor (void *obj_, void *aux) 
+{
+  struct obj *obj = obj_;
+
+  ASSERT (aux == &cache);
+  obj->magic = OBJ_MAGIC;
+  ctor_cnt++;
+}
+
+void
+test_slab (void) 
+{
+  int per_slab, colors;
+  int i, j;
+
+  slab_cache_init (&cache, "test", sizeof (struct obj), OBJ_ALIGN,
+                   obj_ctor, &cache);
+
+  /* The first allocation creates one slab. */
+  objs[0] = slab_alloc (&cache);
+  per_slab = ctor_cnt;
+  if (per_slab < 2)
+    fail ("%d objects per slab", per_slab);
+
+  for (i = 1; i < OBJ_CNT; i++)
+    {
+      objs[i] = slab_alloc (&cache);
+      if (objs[i] == NULL)
+        fail ("allocation %d failed", i);
+    }
+  for (i = 0; i < OBJ_CNT; i++)
+    {
+      if ((uintptr_t) objs[i] % OBJ_ALIGN != 0)
+        fail ("object %d misaligned at %p", i, objs[i]);
+      if (objs[i]->magic != OBJ_MAGIC)
+        fail ("object %d not constructed", i);
+      for (j = 0; j < i; j++)
+        if ((uint8_t *) objs[i] < (uint8_t *) objs[j] + OBJ_SIZE
+            && (uint8_t *) objs[j] < (uint8_t *) objs[i] + OBJ_SIZE)
+          fail ("objects %d and %d overlap", j, i);
+    }
+  if (ctor_cnt != (OBJ_CNT + per_slab - 1) / per_slab * per_slab)
+    fail ("%d constructor calls for %d objects", ctor_cnt, OBJ_CNT);
+  msg ("objects aligned, distinct and constructed once");
+
+  /* The lowest page offset of an object differs between
+     successive slabs. */
+  colors = 0;
+  for (i = 0; i < OBJ_CNT; i++)
+    {
+      for (j = 0; j < i; j++)
+        if (pg_round_down (objs[j]) == pg_round_down (objs[i]))
+          break;
+      if (j == i && (pg_ofs (objs[i]) - pg_ofs (objs[0])) % OBJ_SIZE != 0)
+        colors++;
+    }
+  if (colors == 0)
+    fail ("all slabs have the same color");
+  msg ("slabs colored");
+
+  /* Freeing everything keeps one empty slab, whose objects are
+     reused without running the constructor again. */
+  for (i = 0; i < OBJ_CNT; i++)
+    {
+      memset (objs[i]->data, 0x5a, sizeof objs[i]->data);
+      slab_free (&cache, objs[i]);
+    }
+  i = ctor_cnt;
+  objs[0] = slab_alloc (&cache);
+  if (ctor_cnt != i || objs[0]->magic != OBJ_MAGIC)
+    fail ("freed object not reused in its constructed state");
+  slab_free (&cache, objs[0]);
+  msg ("freed objects reused");
+
+  if (slab_shrink (&cache) != 1)
+    fail ("shrink did not free the empty slab");
+  if (slab_shrink (&cache) != 0)
+    fail ("second shrink freed a slab");
+  objs[0] = slab_alloc (&cache);
+  if (ctor_cnt != i + per_slab)
+    fail ("no new slab after shrink");
+  slab_free (&cache, objs[0]);
+  slab_shrink (&cache);
+  msg ("shrink returned the empty slab");
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(slab) begin
+(slab) objects aligned, distinct and constructed once
+(slab) slabs colored
+(slab) freed objects reused
+(slab) shrink returned the empty slab
+(slab) end
+EOF
+pass;
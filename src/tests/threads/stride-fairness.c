@@ -0,0 +1,64 @@
+/* Runs three CPU-bound threads holding 30, 20 and 10 tickets
+   under the stride scheduler and checks that each one receives
+   its proportional share of the CPU, within 10%. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define THREAD_CNT 3
+
+static thread_func stride_thread;
+static volatile bool running;
+static volatile int64_t iterations[THREAD_CNT];
+
+void
+test_stride_fairness (void) 
+{
+  static const int tickets[THREAD_CNT] = {30, 20, 10};
+  int total_tickets = 0;
+  int64_t total_iterations = 0;
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  set_scheduler (SCHED_STRIDE);
+  running = true;
+  for (i = 0; i < THREAD_CNT; i++) 
+    {
+      char name[16];
+      snprintf (name, sizeof name, "stride %d", i);
+      iterations[i] = 0;
+      total_tickets += tickets[i];
+      thread_create_lottery (name, PRI_DEFAULT, tickets[i],
+                             stride_thread, (void *) &iterations[i]);
+    }
+
+  timer_sleep (5 * TIMER_FREQ);
+  running = false;
+
+  for (i = 0; i < THREAD_CNT; i++)
+    total_iterations += iterations[i];
+  for (i = 0; i < THREAD_CNT; i++) 
+    {
+      int expected = 1000 * tickets[i] / total_tickets;
+      int observed = iterations[i] * 1000 / total_iterations;
+      int error = observed > expected ? observed - expected : expected - observed;
+      if (error * 10 > expected)
+        fail ("thread %d with %d tickets got %d/1000 of the CPU, "
+              "expected %d/1000", i, tickets[i], observed, expected);
+    }
+  pass ();
+}
+
+static void
+stride_thread (void *counter_) 
+{
+  volatile int64_t *counter = counter_;
+
+  while (running)
+    (*counter)++;
+}
@@ -0,0 +1,10 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(stride-fairness) begin
+(stride-fairness) PASS
+(stride-fairness) end
+EOF
+pass;
@@ -41,6 +41,31 @@ static const struct test tests[] =
     {"mlfqs-nice-10", test_mlfqs_nice_10},
     {"mlfqs-block", test_mlfqs_block},
     { "lottery-performance", test_lottery_performance },
+    {"stride-fairness", test_stride_fairness},
+    {"lottery-transfer", test_lottery_transfer},
+    {"lottery-currency", test_lottery_currency},
+    {"sched-bench-switch", test_sched_bench_switch},
+    {"sched-bench-pick", test_sched_bench_pick},
+    {"sched-bench-wake", test_sched_bench_wake},
+    {"sched-bench-share", test_sched_bench_share},
+    {"sched-bench-churn", test_sched_bench_churn},
+    {"edf-admission", test_edf_admission},
+    {"edf-deadline", test_edf_deadline},
+    {"fpu-switch", test_fpu_switch},
+    {"priority-sema-tickets", test_priority_sema_tickets},
+    {"rwlock-readers", test_rwlock_readers},
+    {"rwlock-prefer-writers", test_rwlock_prefer_writers},
+    {"rwlock-prefer-readers", test_rwlock_prefer_readers},
+    {"rwlock-upgrade", test_rwlock_upgrade},
+    {"rwlock-try", test_rwlock_try},
+    {"seqlock", test_seqlock},
+    {"rwlock-bench", test_rwlock_bench},
+    {"palloc-bench", test_palloc_bench},
+    {"palloc-bench-bitmap", test_palloc_bench},
+    {"palloc-zero", test_palloc_zero},
+    {"slab", test_slab},
+    {"malloc-bench", test_malloc_bench},
+    {"malloc-stats", test_malloc_stats},
     
 
   };
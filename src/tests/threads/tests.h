@@ -32,6 +32,30 @@ extern test_func test_mlfqs_fair_20;
 extern test_func test_mlfqs_nice_2;
 extern test_func test_mlfqs_nice_10;
 extern test_func test_mlfqs_block;
+extern test_func test_stride_fairness;
+extern test_func test_lottery_transfer;
+extern test_func test_lottery_currency;
+extern test_func test_sched_bench_switch;
+extern test_func test_sched_bench_pick;
+extern test_func test_sched_bench_wake;
+extern test_func test_sched_bench_share;
+extern test_func test_sched_bench_churn;
+extern test_func test_edf_admission;
+extern test_func test_edf_deadline;
+extern test_func test_fpu_switch;
+extern test_func test_priority_sema_tickets;
+extern test_func test_rwlock_readers;
+extern test_func test_rwlock_prefer_writers;
+extern test_func test_rwlock_prefer_readers;
+extern test_func test_rwlock_upgrade;
+extern test_func test_rwlock_try;
+extern test_func test_seqlock;
+extern test_func test_rwlock_bench;
+extern test_func test_palloc_bench;
+extern test_func test_palloc_zero;
+extern test_func test_slab;
+extern test_func test_malloc_bench;
+extern test_func test_malloc_stats;
 
 void msg (const char *, ...);
 void fail (const char *, ...);
@@ -0,0 +1,25 @@
+#ifndef THREADS_CPU_H
+#define THREADS_CPU_H
+
+#include <stdint.h>
+
+/* Returns the processor's time-stamp counter, which counts clock
+   cycles since reset.  See [IA32-v2b] "RDTSC". */
+static inline uint64_t
+rdtsc (void)
+{
+  uint32_t lo, hi;
+  asm volatile ("rdtsc" : "=a" (lo), "=d" (hi));
+  return ((uint64_t) hi << 32) | lo;
+}
+
+/* Atomically adds N to *P and returns the previous value of *P.
+   See [IA32-v2b] "XADD". */
+static inline int
+atomic_fetch_add (volatile int *p, int n)
+{
+  asm volatile ("lock xaddl %0, %1" : "+r" (n), "+m" (*p) : : "memory");
+  return n;
+}
+
+#endif /* threads/cpu.h */
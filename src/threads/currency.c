@@ -0,0 +1,189 @@
+#include "threads/currency.h"
+#include <debug.h>
+#include <stdint.h>
+#include <string.h>
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+
+static void adjust_active (struct currency *, int delta);
+static void revalue (struct currency *);
+static int64_t currency_value (const struct currency *);
+
+/* Initializes currency C, named NAME, funded with FUNDING tickets
+   of currency PARENT, or of the base currency if PARENT is
+   null. */
+void
+currency_init (struct currency *c, const char *name,
+               struct currency *parent, int funding)
+{
+  enum intr_level old_level;
+
+  ASSERT (c != NULL);
+  ASSERT (name != NULL);
+  ASSERT (funding > 0);
+
+  strlcpy (c->name, name, sizeof c->name);
+  c->parent = parent;
+  c->funding = funding;
+  c->active = 0;
+  list_init (&c->members);
+  list_init (&c->children);
+
+  old_level = intr_disable ();
+  if (parent != NULL)
+    list_push_back (&parent->children, &c->elem);
+  intr_set_level (old_level);
+}
+
+/* Changes the funding of currency C to FUNDING tickets of its
+   parent, revaluing the tickets of every affected thread. */
+void
+currency_set_funding (struct currency *c, int funding)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (funding > 0);
+
+  if (c->active > 0 && c->parent != NULL)
+    {
+      c->parent->active += funding - c->funding;
+      c->funding = funding;
+      revalue (c->parent);
+    }
+  else
+    {
+      c->funding = funding;
+      revalue (c);
+    }
+}
+
+/* Makes thread T hold its tickets in currency C instead of its
+   current currency. */
+void
+currency_join (struct currency *c, struct thread *t)
+{
+  bool active = t->ticket_active;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (c != NULL);
+
+  if (active)
+    currency_deactivate (t);
+  if (t->currency != NULL)
+    list_remove (&t->currency_elem);
+  t->currency = c;
+  list_push_back (&c->members, &t->currency_elem);
+  if (active)
+    currency_activate (t);
+}
+
+/* Makes thread T hold its tickets in the base currency. */
+void
+currency_leave (struct thread *t)
+{
+  bool active = t->ticket_active;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (t->currency == NULL)
+    return;
+  if (active)
+    currency_deactivate (t);
+  list_remove (&t->currency_elem);
+  t->currency = NULL;
+  if (active)
+    currency_activate (t);
+}
+
+/* Counts thread T's tickets as active, because it is becoming
+   runnable. */
+void
+currency_activate (struct thread *t)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (!t->ticket_active);
+
+  t->ticket_active = true;
+  if (t->currency != NULL)
+    adjust_active (t->currency, t->tickets);
+}
+
+/* Stops counting thread T's tickets as active, because it is
+   blocking or exiting. */
+void
+currency_deactivate (struct thread *t)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (t->ticket_active);
+
+  t->ticket_active = false;
+  if (t->currency != NULL)
+    adjust_active (t->currency, -t->tickets);
+}
+
+/* Returns the value of thread T's tickets in base tickets.  If T
+   is not active, returns the value its tickets would have if it
+   were.  A thread with any tickets is worth at least 1. */
+int
+currency_thread_value (const struct thread *t)
+{
+  const struct currency *c = t->currency;
+  int active;
+  int64_t value;
+
+  if (c == NULL || t->tickets == 0)
+    return t->tickets;
+
+  active = c->active + (t->ticket_active ? 0 : t->tickets);
+  value = currency_value (c) * t->tickets / active;
+  return value > 0 ? value : 1;
+}
+
+/* Adds DELTA to the active tickets of currency C.  If C becomes
+   active or inactive as a result, its funding is added to or
+   removed from its parent's active tickets in turn.  Then
+   revalues the threads whose tickets changed value. */
+static void
+adjust_active (struct currency *c, int delta)
+{
+  for (;;)
+    {
+      int old_active = c->active;
+
+      c->active += delta;
+      ASSERT (c->active >= 0);
+      if (c->parent == NULL || (old_active == 0) == (c->active == 0))
+        break;
+      delta = c->active > 0 ? c->funding : -c->funding;
+      c = c->parent;
+    }
+  revalue (c);
+}
+
+/* Updates the lottery tickets of every member of C and of the
+   currencies it funds. */
+static void
+revalue (struct currency *c)
+{
+  struct list_elem *e;
+
+  for (e = list_begin (&c->members); e != list_end (&c->members);
+       e = list_next (e))
+    thread_tickets_changed (list_entry (e, struct thread, currency_elem));
+  for (e = list_begin (&c->children); e != list_end (&c->children);
+       e = list_next (e))
+    revalue (list_entry (e, struct currency, elem));
+}
+
+/* Returns the value of all of currency C's active tickets, in base
+   tickets. */
+static int64_t
+currency_value (const struct currency *c)
+{
+  const struct currency *parent = c->parent;
+  int parent_active;
+
+  if (parent == NULL)
+    return c->funding;
+  parent_active = parent->active + (c->active > 0 ? 0 : c->funding);
+  return currency_value (parent) * c->funding / parent_active;
+}
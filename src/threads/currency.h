@@ -0,0 +1,52 @@
+#ifndef THREADS_CURRENCY_H
+#define THREADS_CURRENCY_H
+
+#include <list.h>
+
+/* Lottery ticket currencies.
+
+   A currency lets a group of threads, such as the threads of one
+   process, share a fixed share of the CPU under the lottery
+   scheduler.  The currency is funded with FUNDING tickets of its
+   parent currency, or of the base currency if it has none, and
+   its members hold tickets denominated in it.  A member's value
+   in base tickets is its share of the currency's active tickets
+   times the currency's own value, so when a member blocks the
+   others' tickets are worth more, and the group as a whole keeps
+   its funding.  A currency whose members are all blocked is
+   inactive and does not count against its parent.
+
+   Only threads that are not blocked count as active, except that
+   a thread blocked on a lock stays active, because it transfers
+   its tickets to the lock's holder (see thread.c).
+
+   New threads join the currency of the thread that creates them.
+   All functions must be called with interrupts off. */
+
+struct thread;
+
+/* A ticket currency. */
+struct currency
+  {
+    char name[16];              /* Name (for debugging purposes). */
+    struct currency *parent;    /* Funding currency, or null for base. */
+    int funding;                /* Tickets of PARENT backing this one. */
+    int active;                 /* Active tickets issued in this one. */
+    struct list members;        /* Threads holding tickets in this one. */
+    struct list children;       /* Currencies funded by this one. */
+    struct list_elem elem;      /* Element in parent's `children'. */
+  };
+
+void currency_init (struct currency *, const char *name,
+                    struct currency *parent, int funding);
+void currency_set_funding (struct currency *, int funding);
+
+void currency_join (struct currency *, struct thread *);
+void currency_leave (struct thread *);
+
+void currency_activate (struct thread *);
+void currency_deactivate (struct thread *);
+
+int currency_thread_value (const struct thread *);
+
+#endif /* threads/currency.h */
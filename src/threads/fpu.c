@@ -0,0 +1,203 @@
+#include "threads/fpu.h"
+#include <debug.h>
+#include <round.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/thread.h"
+
+/* CR0 bits.  See [IA32-v3a] 2.5 "Control Registers". */
+#define CR0_MP 0x00000002       /* Monitor coprocessor. */
+#define CR0_EM 0x00000004       /* Emulation. */
+#define CR0_TS 0x00000008       /* Task switched. */
+#define CR0_NE 0x00000020       /* Numeric error. */
+
+/* CR4 bits. */
+#define CR4_OSFXSR 0x00000200   /* FXSAVE/FXRSTOR and SSE enabled. */
+#define CR4_OSXMMEXCPT 0x00000400 /* SSE exceptions raise #XF. */
+
+/* CPUID leaf 1 EDX bits. */
+#define CPUID_FXSR 0x01000000   /* FXSAVE and FXRSTOR. */
+#define CPUID_SSE 0x02000000    /* SSE. */
+
+/* Saved state size: FXSAVE needs 512 bytes, 16-byte aligned;
+   FNSAVE, used on processors without FXSAVE, needs 108. */
+#define FPU_STATE_SIZE 512
+#define FPU_STATE_ALIGN 16
+
+/* A save area. */
+struct fpu_area
+  {
+    uint8_t data[FPU_STATE_SIZE];
+  };
+
+/* Initial SSE control and status: all exceptions masked. */
+#define MXCSR_DEFAULT 0x1f80
+
+static bool has_fxsr;           /* FXSAVE/FXRSTOR available? */
+static bool has_sse;            /* SSE available? */
+
+/* The thread whose state is in the FPU registers, or null. */
+static struct thread *fpu_owner;
+
+static intr_handler_func nm_handler;
+
+static inline uint32_t
+read_cr0 (void)
+{
+  uint32_t cr0;
+  asm volatile ("movl %%cr0, %0" : "=r" (cr0));
+  return cr0;
+}
+
+static inline void
+write_cr0 (uint32_t cr0)
+{
+  asm volatile ("movl %0, %%cr0" : : "r" (cr0));
+}
+
+/* Returns the 16-byte aligned save area of T, which must have
+   one. */
+static void *
+state_of (struct thread *t)
+{
+  ASSERT (t->fpu_state != NULL);
+  return (void *) ROUND_UP ((uintptr_t) t->fpu_state, FPU_STATE_ALIGN);
+}
+
+/* Saves the FPU registers into T's save area. */
+static void
+save_state (struct thread *t)
+{
+  struct fpu_area *a = state_of (t);
+
+  if (has_fxsr)
+    asm volatile ("fxsave %0" : "=m" (*a));
+  else
+    asm volatile ("fnsave %0" : "=m" (*a));
+}
+
+/* Loads the FPU registers from T's save area. */
+static void
+load_state (struct thread *t)
+{
+  struct fpu_area *a = state_of (t);
+
+  if (has_fxsr)
+    asm volatile ("fxrstor %0" : : "m" (*a));
+  else
+    asm volatile ("frstor %0" : : "m" (*a));
+}
+
+/* Enables the FPU, and SSE if the processor has it, and arms
+   lazy switching.  The boot code leaves CR0.EM set, so that any
+   floating-point instruction traps, until this is called. */
+void
+fpu_init (void)
+{
+  uint32_t eax, ebx, ecx, edx;
+  uint32_t cr4;
+
+  asm ("cpuid" : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx) : "a" (1));
+  has_fxsr = (edx & CPUID_FXSR) != 0;
+  has_sse = has_fxsr && (edx & CPUID_SSE) != 0;
+
+  if (has_sse)
+    {
+      asm volatile ("movl %%cr4, %0" : "=r" (cr4));
+      cr4 |= CR4_OSFXSR | CR4_OSXMMEXCPT;
+      asm volatile ("movl %0, %%cr4" : : "r" (cr4));
+    }
+  write_cr0 ((read_cr0 () & ~CR0_EM) | CR0_MP | CR0_NE | CR0_TS);
+
+  intr_register_int (7, 0, INTR_OFF, nm_handler,
+                     "#NM Device Not Available Exception");
+}
+
+/* Called on every switch to thread CUR, with interrupts off.
+   Lets CUR use the FPU without trapping if its state is still
+   loaded, and otherwise makes its first FPU instruction trap.
+   Writing CR0 serializes the processor, so CR0.TS is changed
+   only if it has the wrong value, which keeps switches among
+   threads that do not use the FPU cheap. */
+void
+fpu_switch (struct thread *cur)
+{
+  uint32_t cr0 = read_cr0 ();
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (cur == fpu_owner)
+    {
+      if (cr0 & CR0_TS)
+        asm volatile ("clts");
+    }
+  else if (!(cr0 & CR0_TS))
+    write_cr0 (cr0 | CR0_TS);
+}
+
+/* Discards the FPU state of T, which is exiting and must be the
+   running thread.  Must be called with interrupts on, because it
+   frees memory. */
+void
+fpu_release (struct thread *t)
+{
+  enum intr_level old_level;
+  void *state;
+
+  old_level = intr_disable ();
+  if (fpu_owner == t)
+    {
+      fpu_owner = NULL;
+      write_cr0 (read_cr0 () | CR0_TS);
+    }
+  state = t->fpu_state;
+  t->fpu_state = NULL;
+  intr_set_level (old_level);
+
+  free (state);
+}
+
+/* #NM handler: the running thread executed an FPU instruction
+   while CR0.TS was set.  Moves the FPU from its previous owner to
+   the running thread. */
+static void
+nm_handler (struct intr_frame *f UNUSED)
+{
+  struct thread *cur = thread_current ();
+  bool first_use = cur->fpu_state == NULL;
+
+  /* Allocate a save area on first use.  malloc() may sleep,
+     during which other threads may take over the FPU, so the
+     owner is checked only afterward. */
+  if (first_use)
+    {
+      cur->fpu_state = malloc (FPU_STATE_SIZE + FPU_STATE_ALIGN - 1);
+      if (cur->fpu_state == NULL)
+        {
+          printf ("%s: out of memory for FPU state\n", cur->name);
+          intr_enable ();
+          thread_exit ();
+        }
+    }
+
+  asm volatile ("clts");
+  if (fpu_owner == cur)
+    return;
+
+  if (fpu_owner != NULL)
+    save_state (fpu_owner);
+  if (first_use)
+    {
+      uint32_t mxcsr = MXCSR_DEFAULT;
+
+      asm volatile ("fninit");
+      if (has_sse)
+        asm volatile ("ldmxcsr %0" : : "m" (mxcsr));
+    }
+  else
+    load_state (cur);
+  fpu_owner = cur;
+}
@@ -0,0 +1,20 @@
+#ifndef THREADS_FPU_H
+#define THREADS_FPU_H
+
+struct thread;
+
+/* Floating-point unit (x87 and SSE) state.
+
+   The FPU registers are switched lazily.  A thread switch only
+   sets CR0.TS, unless the incoming thread is the one whose state
+   is already in the FPU.  The first FPU instruction executed with
+   TS set raises #NM, whose handler saves the state of the
+   previous owner, loads the current thread's and clears TS.  A
+   thread that never touches the FPU thus never pays for it, and
+   needs no space for FPU state. */
+
+void fpu_init (void);
+void fpu_switch (struct thread *);
+void fpu_release (struct thread *);
+
+#endif /* threads/fpu.h */
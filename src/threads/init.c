@@ -15,13 +15,17 @@
 #include "devices/timer.h"
 #include "devices/vga.h"
 #include "devices/rtc.h"
+#include "threads/fpu.h"
 #include "threads/interrupt.h"
 #include "threads/io.h"
 #include "threads/loader.h"
 #include "threads/malloc.h"
+#include "threads/mp.h"
 #include "threads/palloc.h"
+#include "threads/slab.h"
 #include "threads/pte.h"
 #include "threads/thread.h"
+#include "threads/trace.h"
 #ifdef USERPROG
 #include "userprog/process.h"
 #include "userprog/exception.h"
@@ -62,6 +66,8 @@ static void paging_init (void);
 
 static char **read_command_line (void);
 static char **parse_options (char **argv);
+static enum scheduler_type parse_scheduler (const char *name);
+static bool parse_palloc (const char *name);
 static void run_actions (char **argv);
 static void usage (void);
 
@@ -103,7 +109,12 @@ main (void)
   /* Initialize memory system. */
   palloc_init (user_page_limit);
   malloc_init ();
+  slab_init ();
+#ifdef SCHED_TRACE
+  trace_init ();
+#endif
   paging_init ();
+  mp_init ();
 
   /* Segmentation. */
 #ifdef USERPROG
@@ -113,6 +124,7 @@ main (void)
 
   /* Initialize interrupt handlers. */
   intr_init ();
+  fpu_init ();
   timer_init ();
   kbd_init ();
   input_init ();
@@ -263,6 +275,24 @@ parse_options (char **argv)
         random_init (atoi (value));
       else if (!strcmp (name, "-mlfqs"))
         thread_mlfqs = true;
+      else if (!strcmp (name, "-sched"))
+        current_scheduler = parse_scheduler (value);
+      else if (!strcmp (name, "-tickless"))
+        timer_tickless = true;
+      else if (!strcmp (name, "-apic"))
+        intr_apic_enabled = true;
+      else if (!strcmp (name, "-apictimer"))
+        intr_apic_enabled = timer_lapic = true;
+      else if (!strcmp (name, "-palloc"))
+        palloc_bitmap = parse_palloc (value);
+#ifdef ALLOC_STATS
+      else if (!strcmp (name, "-allocsites"))
+        malloc_sites = true;
+#endif
+#ifdef SCHED_TRACE
+      else if (!strcmp (name, "-trace"))
+        trace_set_output (value);
+#endif
 #ifdef USERPROG
       else if (!strcmp (name, "-ul"))
         user_page_limit = atoi (value);
@@ -284,6 +314,37 @@ parse_options (char **argv)
   return argv;
 }
 
+/* Returns the scheduler named NAME, as given to the -sched
+   option. */
+static enum scheduler_type
+parse_scheduler (const char *name)
+{
+  if (name == NULL)
+    PANIC ("option `-sched' requires an argument (use -h for help)");
+  else if (!strcmp (name, "rr"))
+    return SCHED_ROUND_ROBIN;
+  else if (!strcmp (name, "lottery"))
+    return SCHED_LOTTERY;
+  else if (!strcmp (name, "stride"))
+    return SCHED_STRIDE;
+  PANIC ("unknown scheduler `%s' (use -h for help)", name);
+}
+
+/* Returns true if the page allocator named NAME, as given to the
+   -palloc option, is the bitmap allocator, false if it is the
+   buddy allocator. */
+static bool
+parse_palloc (const char *name)
+{
+  if (name == NULL)
+    PANIC ("option `-palloc' requires an argument (use -h for help)");
+  else if (!strcmp (name, "buddy"))
+    return false;
+  else if (!strcmp (name, "bitmap"))
+    return true;
+  PANIC ("unknown page allocator `%s' (use -h for help)", name);
+}
+
 /* Runs the task specified in ARGV[1]. */
 static void
 run_task (char **argv)
@@ -386,6 +447,17 @@ usage (void)
 #endif
           "  -rs=SEED           Set random number seed to SEED.\n"
           "  -mlfqs             Use multi-level feedback queue scheduler.\n"
+          "  -sched=NAME        Use scheduler NAME: rr, lottery or stride.\n"
+          "  -tickless          Stop the periodic timer tick while idle.\n"
+          "  -apic              Use the APICs instead of the 8259 PICs.\n"
+          "  -apictimer         Use the local APIC timer; implies -apic.\n"
+          "  -palloc=NAME       Use page allocator NAME: buddy or bitmap.\n"
+#ifdef ALLOC_STATS
+          "  -allocsites        Count malloc() calls by call site.\n"
+#endif
+#ifdef SCHED_TRACE
+          "  -trace=DEST        Dump scheduler trace to serial or BDEV.\n"
+#endif
 #ifdef USERPROG
           "  -ul=COUNT          Limit user memory to COUNT pages.\n"
 #endif
@@ -57,13 +57,20 @@ struct intr_frame
 
 typedef void intr_handler_func (struct intr_frame *);
 
+/* If true, deliver interrupts through the APICs, if there are
+   any, instead of the 8259 PICs. */
+extern bool intr_apic_enabled;
+
 void intr_init (void);
+bool intr_apic_mode (void);
 void intr_register_ext (uint8_t vec, intr_handler_func *, const char *name);
 void intr_register_int (uint8_t vec, int dpl, enum intr_level,
                         intr_handler_func *, const char *name);
 bool intr_context (void);
 void intr_yield_on_return (void);
+bool intr_is_pending (uint8_t vec);
 
+void intr_print_stats (void);
 void intr_dump_frame (const struct intr_frame *);
 const char *intr_name (uint8_t vec);
 
@@ -0,0 +1,117 @@
+#include "threads/ioapic.h"
+#include <debug.h>
+#include <stddef.h>
+#include "threads/mmio.h"
+#include "threads/mp.h"
+
+/* Memory-mapped registers.  The I/O APIC's internal registers are
+   read and written indirectly: the index goes in IOREGSEL, then
+   the data is accessed through IOWIN. */
+#define IOREGSEL        0x00    /* Register index. */
+#define IOWIN           0x10    /* Register data. */
+
+/* Internal registers. */
+#define IOAPIC_VER      0x01    /* Version and number of pins. */
+#define IOAPIC_REDTBL   0x10    /* Redirection table, 2 per pin. */
+
+/* Redirection table entry bits, low half.  The high half holds
+   the destination local APIC ID in its top byte. */
+#define RED_ACTIVE_LOW  0x00002000      /* Polarity: active low. */
+#define RED_LEVEL       0x00008000      /* Trigger: level. */
+#define RED_MASKED      0x00010000      /* Interrupt masked. */
+
+/* I/O APIC registers, or null if there is no I/O APIC. */
+static uint8_t *ioapic;
+
+/* Number of input pins. */
+static int pin_cnt;
+
+static uint32_t
+ioapic_read (int reg)
+{
+  mmio_write32 (ioapic + IOREGSEL, reg);
+  return mmio_read32 (ioapic + IOWIN);
+}
+
+static void
+ioapic_write (int reg, uint32_t data)
+{
+  mmio_write32 (ioapic + IOREGSEL, reg);
+  mmio_write32 (ioapic + IOWIN, data);
+}
+
+/* Maps the registers of the I/O APIC given by the MP configuration
+   table and masks all of its inputs.  Returns true if successful,
+   false if the machine has no I/O APIC. */
+bool
+ioapic_init (void)
+{
+  int pin;
+
+  if (mp_ioapic_addr == 0)
+    return false;
+  ioapic = mmio_map (mp_ioapic_addr);
+  pin_cnt = ((ioapic_read (IOAPIC_VER) >> 16) & 0xff) + 1;
+
+  for (pin = 0; pin < pin_cnt; pin++)
+    {
+      ioapic_write (IOAPIC_REDTBL + 2 * pin, RED_MASKED);
+      ioapic_write (IOAPIC_REDTBL + 2 * pin + 1, 0);
+    }
+  return true;
+}
+
+/* Returns the I/O APIC pin that ISA interrupt IRQ is wired to, or
+   -1 if it is not wired to any. */
+static int
+irq_pin (int irq)
+{
+  int pin;
+
+  ASSERT (ioapic != NULL);
+  ASSERT (irq >= 0 && irq < MP_ISA_IRQS);
+
+  pin = mp_isa_irqs[irq].pin;
+  return pin < pin_cnt ? pin : -1;
+}
+
+/* Routes ISA interrupt IRQ to interrupt vector VEC of the
+   processor whose local APIC ID is APIC_ID.  The interrupt is
+   left masked. */
+void
+ioapic_route (int irq, uint8_t vec, uint8_t apic_id)
+{
+  const struct mp_irq *mi = &mp_isa_irqs[irq];
+  int pin = irq_pin (irq);
+  uint32_t lo;
+
+  if (pin < 0)
+    return;
+
+  lo = RED_MASKED | vec;
+  if (mi->active_low)
+    lo |= RED_ACTIVE_LOW;
+  if (mi->level)
+    lo |= RED_LEVEL;
+  ioapic_write (IOAPIC_REDTBL + 2 * pin + 1, (uint32_t) apic_id << 24);
+  ioapic_write (IOAPIC_REDTBL + 2 * pin, lo);
+}
+
+/* Masks ISA interrupt IRQ if MASKED is true, otherwise unmasks
+   it. */
+void
+ioapic_mask (int irq, bool masked)
+{
+  int pin = irq_pin (irq);
+  uint32_t lo;
+
+  if (pin < 0)
+    return;
+
+  lo = ioapic_read (IOAPIC_REDTBL + 2 * pin);
+  if (masked)
+    lo |= RED_MASKED;
+  else
+    lo &= ~RED_MASKED;
+  ioapic_write (IOAPIC_REDTBL + 2 * pin, lo);
+}
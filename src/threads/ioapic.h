@@ -0,0 +1,18 @@
+#ifndef THREADS_IOAPIC_H
+#define THREADS_IOAPIC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* I/O APIC, which routes device interrupts to the local APICs of
+   the processors.  See [82093AA].
+
+   Interrupts are identified by their ISA IRQ number, 0...15.  The
+   MP configuration table says which I/O APIC input pin each one
+   is wired to, and its polarity and trigger mode. */
+
+bool ioapic_init (void);
+void ioapic_route (int irq, uint8_t vec, uint8_t apic_id);
+void ioapic_mask (int irq, bool masked);
+
+#endif /* threads/ioapic.h */
@@ -0,0 +1,148 @@
+#include "threads/lapic.h"
+#include <debug.h>
+#include <stddef.h>
+#include "threads/mmio.h"
+#include "threads/mp.h"
+
+/* Register offsets. */
+#define LAPIC_ID        0x020   /* Local APIC ID. */
+#define LAPIC_TPR       0x080   /* Task priority. */
+#define LAPIC_EOI       0x0b0   /* End of interrupt. */
+#define LAPIC_SVR       0x0f0   /* Spurious interrupt vector. */
+#define LAPIC_IRR       0x200   /* Interrupt request, 8 registers. */
+#define LAPIC_ESR       0x280   /* Error status. */
+#define LAPIC_LVT_TIMER 0x320   /* Local vector table: timer. */
+#define LAPIC_LVT_LINT0 0x350   /* Local vector table: LINT0. */
+#define LAPIC_LVT_LINT1 0x360   /* Local vector table: LINT1. */
+#define LAPIC_LVT_ERROR 0x370   /* Local vector table: error. */
+#define LAPIC_TIMER_ICR 0x380   /* Timer initial count. */
+#define LAPIC_TIMER_CCR 0x390   /* Timer current count. */
+#define LAPIC_TIMER_DCR 0x3e0   /* Timer divide configuration. */
+
+/* Register bits. */
+#define SVR_ENABLE      0x00000100      /* APIC software enable. */
+#define LVT_MASKED      0x00010000      /* Interrupt masked. */
+#define LVT_PERIODIC    0x00020000      /* Timer mode: periodic. */
+#define DCR_DIV_16      0x00000003      /* Timer clock: bus clock / 16. */
+
+/* Local APIC registers, or null if there is no local APIC. */
+static uint8_t *lapic;
+
+static uint32_t
+lapic_read (int reg)
+{
+  return mmio_read32 (lapic + reg);
+}
+
+static void
+lapic_write (int reg, uint32_t data)
+{
+  mmio_write32 (lapic + reg, data);
+}
+
+/* Maps the local APIC registers, at the address given by the MP
+   configuration table.  Returns true if successful, false if the
+   machine has no local APIC.  Leaves the bootstrap processor's
+   local APIC as the BIOS set it up, which passes the 8259's
+   interrupts through, until lapic_enable() is called.  May be
+   called more than once. */
+bool
+lapic_init (void)
+{
+  if (mp_lapic_addr == 0)
+    return false;
+  lapic = mmio_map (mp_lapic_addr);
+  return true;
+}
+
+/* Returns true if lapic_init() found a local APIC. */
+bool
+lapic_present (void)
+{
+  return lapic != NULL;
+}
+
+/* Enables the local APIC of the processor that calls it, with all
+   of its local interrupts masked, including the LINT0 input
+   through which the 8259's interrupts would otherwise arrive.
+   Interrupts then come only from the I/O APIC and the local APIC
+   timer. */
+void
+lapic_enable (void)
+{
+  ASSERT (lapic != NULL);
+
+  lapic_write (LAPIC_SVR, SVR_ENABLE | LAPIC_SPURIOUS_VEC);
+  lapic_write (LAPIC_LVT_TIMER, LVT_MASKED);
+  lapic_write (LAPIC_LVT_LINT0, LVT_MASKED);
+  lapic_write (LAPIC_LVT_LINT1, LVT_MASKED);
+  lapic_write (LAPIC_LVT_ERROR, LVT_MASKED);
+  lapic_write (LAPIC_ESR, 0);
+  lapic_write (LAPIC_ESR, 0);
+  lapic_write (LAPIC_TPR, 0);
+}
+
+/* Returns the local APIC ID of the calling processor. */
+uint8_t
+lapic_id (void)
+{
+  ASSERT (lapic != NULL);
+  return lapic_read (LAPIC_ID) >> 24;
+}
+
+/* Signals the end of the interrupt being handled. */
+void
+lapic_eoi (void)
+{
+  lapic_write (LAPIC_EOI, 0);
+}
+
+/* Returns true if interrupt VEC has been accepted by the local
+   APIC but not yet delivered to the processor. */
+bool
+lapic_is_pending (uint8_t vec)
+{
+  return (lapic_read (LAPIC_IRR + vec / 32 * 0x10) & (1u << (vec % 32))) != 0;
+}
+
+/* Local APIC timer.
+
+   The timer counts down at a model-specific rate derived from the
+   bus clock, which the caller must calibrate against another
+   clock.  When the count reaches zero it raises its interrupt and,
+   in periodic mode, starts over from the initial count. */
+
+/* Starts the timer counting down from COUNT in periodic mode,
+   raising interrupt VEC each time it reaches zero. */
+void
+lapic_timer_periodic (uint8_t vec, uint32_t count)
+{
+  ASSERT (lapic != NULL);
+  ASSERT (count > 0);
+
+  lapic_write (LAPIC_TIMER_DCR, DCR_DIV_16);
+  lapic_write (LAPIC_LVT_TIMER, LVT_PERIODIC | vec);
+  lapic_write (LAPIC_TIMER_ICR, count);
+}
+
+/* Starts the timer counting down from COUNT once, raising
+   interrupt VEC when it reaches zero, or no interrupt at all if
+   MASKED is true. */
+void
+lapic_timer_one_shot (uint8_t vec, uint32_t count, bool masked)
+{
+  ASSERT (lapic != NULL);
+  ASSERT (count > 0);
+
+  lapic_write (LAPIC_TIMER_DCR, DCR_DIV_16);
+  lapic_write (LAPIC_LVT_TIMER, (masked ? LVT_MASKED : 0) | vec);
+  lapic_write (LAPIC_TIMER_ICR, count);
+}
+
+/* Returns the timer's current count, which is 0 once a one-shot
+   count has run out. */
+uint32_t
+lapic_timer_count (void)
+{
+  return lapic_read (LAPIC_TIMER_CCR);
+}
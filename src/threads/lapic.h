@@ -0,0 +1,26 @@
+#ifndef THREADS_LAPIC_H
+#define THREADS_LAPIC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Local APIC, the per-processor interrupt controller.  See
+   [IA32-v3a] chapter 8 "Advanced Programmable Interrupt
+   Controller (APIC)". */
+
+/* Vector for spurious local APIC interrupts. */
+#define LAPIC_SPURIOUS_VEC 0xff
+
+bool lapic_init (void);
+void lapic_enable (void);
+bool lapic_present (void);
+uint8_t lapic_id (void);
+void lapic_eoi (void);
+bool lapic_is_pending (uint8_t vec);
+
+/* Local APIC timer. */
+void lapic_timer_periodic (uint8_t vec, uint32_t count);
+void lapic_timer_one_shot (uint8_t vec, uint32_t count, bool masked);
+uint32_t lapic_timer_count (void);
+
+#endif /* threads/lapic.h */
@@ -1,7 +1,12 @@
-#include "lottery_rbt.h"
+#include "threads/lottery_rbt.h"
+#include <debug.h>
 #include <stddef.h>
-#include <stdlib.h>
-#include <stdbool.h>
+#include "threads/thread.h"
+
+/* Augmented red-black tree for the lottery scheduler.  See
+   lottery_rbt.h for an overview.  Insertion and deletion are the
+   usual red-black algorithms; rotations and deletion additionally
+   maintain each node's `subtree_total'. */
 
 static int get_subtree_total(struct ticket_node *node) {
   return node ? node->subtree_total : 0;
@@ -12,10 +17,15 @@ static void update_subtree_total(struct ticket_node *node) {
     node->subtree_total = node->tickets + get_subtree_total(node->left) + get_subtree_total(node->right);
 }
 
+/* Returns the number of tickets held by all the threads in the
+   tree rooted at ROOT. */
 int rbt_total_tickets(struct ticket_node *root) {
   return get_subtree_total(root);
 }
 
+/* Returns the thread holding TICKET, counting from 1 in tid order,
+   in the tree rooted at NODE, or a null pointer if TICKET is out
+   of range. */
 struct thread *rbt_pick(struct ticket_node *node, int ticket) {
   while (node) {
     int left_total = get_subtree_total(node->left);
@@ -62,51 +72,53 @@ static void right_rotate(struct ticket_node **root, struct ticket_node *y) {
 }
 
 static void insert_fixup(struct ticket_node **root, struct ticket_node *z) {
-  while (z->parent && z->parent->color == RED) {
+  while (z->parent && z->parent->color == RBT_RED) {
     if (z->parent == z->parent->parent->left) {
       struct ticket_node *y = z->parent->parent->right;
-      if (y && y->color == RED) {
-        z->parent->color = BLACK;
-        y->color = BLACK;
-        z->parent->parent->color = RED;
+      if (y && y->color == RBT_RED) {
+        z->parent->color = RBT_BLACK;
+        y->color = RBT_BLACK;
+        z->parent->parent->color = RBT_RED;
         z = z->parent->parent;
       } else {
         if (z == z->parent->right) {
           z = z->parent;
           left_rotate(root, z);
         }
-        z->parent->color = BLACK;
-        z->parent->parent->color = RED;
+        z->parent->color = RBT_BLACK;
+        z->parent->parent->color = RBT_RED;
         right_rotate(root, z->parent->parent);
       }
     } else {
       struct ticket_node *y = z->parent->parent->left;
-      if (y && y->color == RED) {
-        z->parent->color = BLACK;
-        y->color = BLACK;
-        z->parent->parent->color = RED;
+      if (y && y->color == RBT_RED) {
+        z->parent->color = RBT_BLACK;
+        y->color = RBT_BLACK;
+        z->parent->parent->color = RBT_RED;
         z = z->parent->parent;
       } else {
         if (z == z->parent->left) {
           z = z->parent;
           right_rotate(root, z);
         }
-        z->parent->color = BLACK;
-        z->parent->parent->color = RED;
+        z->parent->color = RBT_BLACK;
+        z->parent->parent->color = RBT_RED;
         left_rotate(root, z->parent->parent);
       }
     }
   }
-  (*root)->color = BLACK;
+  (*root)->color = RBT_BLACK;
 }
 
-void rbt_insert(struct ticket_node **root, struct thread *t) {
-  struct ticket_node *z = malloc(sizeof(struct ticket_node));
+/* Inserts thread T, holding TICKETS tickets, into the tree rooted
+   at *ROOT, using the node embedded in T. */
+void rbt_insert(struct ticket_node **root, struct thread *t, int tickets) {
+  struct ticket_node *z = &t->ticket_elem;
   z->t = t;
-  z->tickets = t->tickets;
-  z->subtree_total = t->tickets;
+  z->tickets = tickets;
+  z->subtree_total = tickets;
   z->left = z->right = z->parent = NULL;
-  z->color = RED;
+  z->color = RBT_RED;
 
   struct ticket_node *y = NULL;
   struct ticket_node *x = *root;
@@ -136,82 +148,74 @@ static void transplant(struct ticket_node **root, struct ticket_node *u, struct
 }
 
 static void remove_fixup(struct ticket_node **root, struct ticket_node *x, struct ticket_node *x_parent) {
-  while (x != *root && (!x || x->color == BLACK)) {
+  while (x != *root && (!x || x->color == RBT_BLACK)) {
     if (x == x_parent->left) {
       struct ticket_node *w = x_parent->right;
-      if (w && w->color == RED) {
-        w->color = BLACK;
-        x_parent->color = RED;
+      if (w && w->color == RBT_RED) {
+        w->color = RBT_BLACK;
+        x_parent->color = RBT_RED;
         left_rotate(root, x_parent);
         w = x_parent->right;
       }
-      if ((!w->left || w->left->color == BLACK) && (!w->right || w->right->color == BLACK)) {
-        w->color = RED;
+      if ((!w->left || w->left->color == RBT_BLACK) && (!w->right || w->right->color == RBT_BLACK)) {
+        w->color = RBT_RED;
         x = x_parent;
         x_parent = x->parent;
       } else {
-        if (!w->right || w->right->color == BLACK) {
-          if (w->left) w->left->color = BLACK;
-          w->color = RED;
+        if (!w->right || w->right->color == RBT_BLACK) {
+          if (w->left) w->left->color = RBT_BLACK;
+          w->color = RBT_RED;
           right_rotate(root, w);
           w = x_parent->right;
         }
         w->color = x_parent->color;
-        x_parent->color = BLACK;
-        if (w->right) w->right->color = BLACK;
+        x_parent->color = RBT_BLACK;
+        if (w->right) w->right->color = RBT_BLACK;
         left_rotate(root, x_parent);
         x = *root;
         break;
       }
     } else {
       struct ticket_node *w = x_parent->left;
-      if (w && w->color == RED) {
-        w->color = BLACK;
-        x_parent->color = RED;
+      if (w && w->color == RBT_RED) {
+        w->color = RBT_BLACK;
+        x_parent->color = RBT_RED;
         right_rotate(root, x_parent);
         w = x_parent->left;
       }
-      if ((!w->right || w->right->color == BLACK) && (!w->left || w->left->color == BLACK)) {
-        w->color = RED;
+      if ((!w->right || w->right->color == RBT_BLACK) && (!w->left || w->left->color == RBT_BLACK)) {
+        w->color = RBT_RED;
         x = x_parent;
         x_parent = x->parent;
       } else {
-        if (!w->left || w->left->color == BLACK) {
-          if (w->right) w->right->color = BLACK;
-          w->color = RED;
+        if (!w->left || w->left->color == RBT_BLACK) {
+          if (w->right) w->right->color = RBT_BLACK;
+          w->color = RBT_RED;
           left_rotate(root, w);
           w = x_parent->left;
         }
         w->color = x_parent->color;
-        x_parent->color = BLACK;
-        if (w->left) w->left->color = BLACK;
+        x_parent->color = RBT_BLACK;
+        if (w->left) w->left->color = RBT_BLACK;
         right_rotate(root, x_parent);
         x = *root;
         break;
       }
     }
   }
-  if (x) x->color = BLACK;
+  if (x) x->color = RBT_BLACK;
 }
 
+/* Removes thread T, which must be in the tree rooted at *ROOT. */
 void rbt_remove(struct ticket_node **root, struct thread *t) {
-  struct ticket_node *z = *root;
-  while (z && z->t != t) {
-    if (t->tid < z->t->tid) z = z->left;
-    else z = z->right;
-  }
-  if (!z) return;
-
-  struct ticket_node *p = z->parent;
-  while (p) {
-    p->subtree_total -= z->tickets;
-    p = p->parent;
-  }
-
+  struct ticket_node *z = &t->ticket_elem;
   struct ticket_node *y = z;
   struct ticket_node *x = NULL;
   struct ticket_node *x_parent = NULL;
-  enum color y_original_color = y->color;
+  struct ticket_node *p;
+  enum rbt_color y_original_color = y->color;
+
+  ASSERT (z->t == t);
 
   if (!z->left) {
     x = z->right;
@@ -239,10 +243,16 @@ void rbt_remove(struct ticket_node **root, struct thread *t) {
     y->left = z->left;
     if (y->left) y->left->parent = y;
     y->color = z->color;
-    update_subtree_total(y);
   }
 
-  free(z);
-  if (y_original_color == BLACK)
+  /* Every node whose subtree lost a node lies on the path from
+     X_PARENT to the root (when Z had two children, that path
+     runs through Y, which has taken Z's place).  The rotations
+     done by remove_fixup() keep the totals consistent. */
+  for (p = x_parent; p != NULL; p = p->parent)
+    update_subtree_total(p);
+
+  z->t = NULL;
+  if (y_original_color == RBT_BLACK)
     remove_fixup(root, x, x_parent);
 }
@@ -0,0 +1,39 @@
+#ifndef THREADS_LOTTERY_RBT_H
+#define THREADS_LOTTERY_RBT_H
+
+/* Red-black tree of ready threads, keyed by tid and augmented
+   with the total number of tickets in each subtree, so that the
+   lottery scheduler can total the tickets and find the holder of
+   a given ticket in O(log n) time.
+
+   The nodes are embedded in struct thread (see the `ticket_elem'
+   member), so inserting and removing threads never allocates
+   memory and is safe in an interrupt handler. */
+
+struct thread;
+
+/* Node colors. */
+enum rbt_color
+  {
+    RBT_RED,
+    RBT_BLACK
+  };
+
+/* Tree node. */
+struct ticket_node
+  {
+    struct ticket_node *parent;         /* Parent, or null for the root. */
+    struct ticket_node *left;           /* Left child. */
+    struct ticket_node *right;          /* Right child. */
+    enum rbt_color color;               /* Node color. */
+    int tickets;                        /* Tickets held by this thread. */
+    int subtree_total;                  /* Tickets held by this subtree. */
+    struct thread *t;                   /* Thread owning this node. */
+  };
+
+void rbt_insert (struct ticket_node **root, struct thread *, int tickets);
+void rbt_remove (struct ticket_node **root, struct thread *);
+struct thread *rbt_pick (struct ticket_node *root, int ticket);
+int rbt_total_tickets (struct ticket_node *root);
+
+#endif /* threads/lottery_rbt.h */
@@ -5,17 +5,21 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include "threads/interrupt.h"
 #include "threads/palloc.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
 
 /* A simple implementation of malloc().
 
-   The size of each request, in bytes, is rounded up to a power
-   of 2 and assigned to the "descriptor" that manages blocks of
-   that size.  The descriptor keeps a list of free blocks.  If
-   the free list is nonempty, one of its blocks is used to
-   satisfy the request.
+   The size of each request, in bytes, is rounded up to the next
+   "size class" and assigned to the "descriptor" that manages
+   blocks of that size.  There are four size classes for each
+   power of 2, a quarter of that power apart (32, 40, 48, 56, 64,
+   80, ...), so that no more than about a fifth of a block is
+   wasted.  The descriptor keeps a list of free blocks.  If the
+   free list is nonempty, one of its blocks is used to satisfy
+   the request.
 
    Otherwise, a new page of memory, called an "arena", is
    obtained from the page allocator (if none is available,
@@ -28,11 +32,42 @@
    blocks, we remove all of the arena's blocks from the free list
    and give the arena back to the page allocator.
 
-   We can't handle blocks bigger than 2 kB using this scheme,
-   because they're too big to fit in a single page with a
+   In front of the free list, each descriptor has a small
+   "magazine" of recently freed blocks, after Bonwick and Adams,
+   "Magazines and Vmem" (USENIX 2001).  malloc() takes a block
+   from the magazine and free() puts one into it with interrupts
+   briefly off, without the descriptor's lock.  Only when the
+   magazine is empty or full does the call take the lock and move
+   blocks between the magazine and the free list.  Blocks in a
+   magazine still count as in use in their arenas; under memory
+   pressure the page allocator has malloc_reclaim() empty the
+   magazines.
+
+   We can't handle blocks bigger than MAX_CLASS_SIZE using this
+   scheme, because too few of them fit in a single page with a
    descriptor.  We handle those by allocating contiguous pages
    with the page allocator and sticking the allocation size at
-   the beginning of the allocated block's arena header. */
+   the beginning of the allocated block's arena header.  realloc()
+   grows such a block in place if the pages after it are free.
+   Only these big blocks grow in place.  A block from a size
+   class is surrounded by blocks of the same class in its arena,
+   so realloc() keeps it only if the new size still fits in it,
+   and otherwise moves it to a block of a larger class.
+
+   In a kernel built with "make ALLOC_STATS=1", each size class
+   counts the blocks and arenas it has in use, the most it ever
+   had, and the bytes requested from it, so that the waste from
+   rounding up and from partly used arenas can be seen.  With the
+   -allocsites option, allocations are also counted by the
+   address malloc() returns to, in a fixed-size table; the
+   `backtrace' utility turns the addresses into function names.
+   Blocks have no headers, so frees cannot be charged back to a
+   call site: the table shows who allocates, not who leaks.
+   malloc_print_stats() prints it all, at power-off or whenever a
+   test calls it. */
+
+/* Blocks in a descriptor's magazine. */
+#define MAG_SIZE 8
 
 /* Descriptor. */
 struct desc
@@ -41,6 +76,13 @@ struct desc
     size_t blocks_per_arena;    /* Number of blocks in an arena. */
     struct list free_list;      /* List of free blocks. */
     struct lock lock;           /* Lock. */
+
+    /* Accessed with interrupts off. */
+    struct block *mag[MAG_SIZE]; /* Magazine of free blocks. */
+    size_t mag_cnt;             /* Number of blocks in magazine. */
+#ifdef ALLOC_STATS
+    struct malloc_stats stats;  /* Statistics. */
+#endif
   };
 
 /* Magic number for detecting arena corruption. */
@@ -60,38 +102,118 @@ struct block
     struct list_elem free_elem; /* Free list element. */
   };
 
+/* Largest block size handled by a descriptor.  At least two
+   blocks of this size fit in an arena. */
+#define MAX_CLASS_SIZE 1792
+
 /* Our set of descriptors. */
-static struct desc descs[10];   /* Descriptors. */
+static struct desc descs[32];   /* Descriptors. */
 static size_t desc_cnt;         /* Number of descriptors. */
 
+/* Maps a request size, rounded up to a multiple of 8 and divided
+   by 8, to the index of the smallest descriptor that fits it. */
+static uint8_t size_class[MAX_CLASS_SIZE / 8 + 1];
+
 static struct arena *block_to_arena (struct block *);
 static struct block *arena_to_block (struct arena *, size_t idx);
+static bool release_block (struct desc *, struct block *);
+static size_t malloc_reclaim (void);
+
+#ifdef ALLOC_STATS
+bool malloc_sites;
+
+/* Statistics for blocks too big for any descriptor.  Accessed
+   with interrupts off. */
+static struct malloc_stats big_stats;
+
+/* Allocations by call site. */
+#define SITE_CNT 256
+struct site
+  {
+    void *caller;               /* Return address, or null if unused. */
+    unsigned allocs;            /* Blocks allocated. */
+    unsigned long long bytes;   /* Bytes requested. */
+  };
+static struct site sites[SITE_CNT];
+static unsigned site_overflows; /* Allocations with no free entry. */
+
+static void count_alloc (struct malloc_stats *, size_t size, size_t bytes,
+                         void *caller);
+static void count_free (struct malloc_stats *, size_t bytes);
+static void count_arenas (struct malloc_stats *, int delta);
+
+#define COUNT_ALLOC(S, SIZE, BYTES, CALLER) \
+        count_alloc (S, SIZE, BYTES, CALLER)
+#define COUNT_FREE(S, BYTES) count_free (S, BYTES)
+#define COUNT_ARENAS(S, DELTA) count_arenas (S, DELTA)
+#else
+#define COUNT_ALLOC(S, SIZE, BYTES, CALLER) ((void) 0)
+#define COUNT_FREE(S, BYTES) ((void) 0)
+#define COUNT_ARENAS(S, DELTA) ((void) 0)
+#endif
+
+/* Adds a descriptor for blocks of BLOCK_SIZE bytes. */
+static void
+add_desc (size_t block_size) 
+{
+  struct desc *d = &descs[desc_cnt++];
+
+  ASSERT (desc_cnt <= sizeof descs / sizeof *descs);
+  d->block_size = block_size;
+  d->blocks_per_arena = (PGSIZE - sizeof (struct arena)) / block_size;
+  list_init (&d->free_list);
+  lock_init (&d->lock);
+  d->mag_cnt = 0;
+#ifdef ALLOC_STATS
+  d->stats.block_size = block_size;
+#endif
+}
 
 /* Initializes the malloc() descriptors. */
 void
 malloc_init (void) 
 {
-  size_t block_size;
+  size_t power, quarters, i, d;
+
+  add_desc (16);
+  add_desc (24);
+  for (power = 32; power <= MAX_CLASS_SIZE; power *= 2)
+    for (quarters = 4; quarters < 8; quarters++)
+      if (power * quarters / 4 <= MAX_CLASS_SIZE)
+        add_desc (power * quarters / 4);
+  ASSERT (descs[desc_cnt - 1].block_size == MAX_CLASS_SIZE);
 
-  for (block_size = 16; block_size < PGSIZE / 2; block_size *= 2)
+  for (i = d = 0; i < sizeof size_class; i++)
     {
-      struct desc *d = &descs[desc_cnt++];
-      ASSERT (desc_cnt <= sizeof descs / sizeof *descs);
-      d->block_size = block_size;
-      d->blocks_per_arena = (PGSIZE - sizeof (struct arena)) / block_size;
-      list_init (&d->free_list);
-      lock_init (&d->lock);
+      while (descs[d].block_size < i * 8)
+        d++;
+      size_class[i] = d;
     }
+
+  palloc_register_reclaim (malloc_reclaim);
 }
 
-/* Obtains and returns a new block of at least SIZE bytes.
-   Returns a null pointer if memory is not available. */
-void *
-malloc (size_t size) 
+/* Returns the smallest descriptor for blocks of at least SIZE
+   bytes, or a null pointer if SIZE is too big for any
+   descriptor. */
+static struct desc *
+size_to_desc (size_t size) 
+{
+  if (size > MAX_CLASS_SIZE)
+    return NULL;
+  return &descs[size_class[DIV_ROUND_UP (size, 8)]];
+}
+
+/* Obtains and returns a new block of at least SIZE bytes for
+   the function that will return to CALLER.  Returns a null
+   pointer if memory is not available. */
+static void *
+allocate (size_t size, void *caller UNUSED) 
 {
   struct desc *d;
   struct block *b;
   struct arena *a;
+  enum intr_level old_level;
 
   /* A null pointer satisfies a request for 0 bytes. */
   if (size == 0)
@@ -99,10 +221,8 @@ malloc (size_t size)
 
   /* Find the smallest descriptor that satisfies a SIZE-byte
      request. */
-  for (d = descs; d < descs + desc_cnt; d++)
-    if (d->block_size >= size)
-      break;
-  if (d == descs + desc_cnt) 
+  d = size_to_desc (size);
+  if (d == NULL) 
     {
       /* SIZE is too big for any descriptor.
          Allocate enough pages to hold SIZE plus an arena. */
@@ -116,9 +236,22 @@ malloc (size_t size)
       a->magic = ARENA_MAGIC;
       a->desc = NULL;
       a->free_cnt = page_cnt;
+      COUNT_ALLOC (&big_stats, size, PGSIZE * page_cnt, caller);
+      COUNT_ARENAS (&big_stats, page_cnt);
       return a + 1;
     }
 
+  /* Fast path: take a block from the magazine. */
+  old_level = intr_disable ();
+  if (d->mag_cnt > 0)
+    {
+      b = d->mag[--d->mag_cnt];
+      intr_set_level (old_level);
+      COUNT_ALLOC (&d->stats, size, d->block_size, caller);
+      return b;
+    }
+  intr_set_level (old_level);
+
   lock_acquire (&d->lock);
 
   /* If the free list is empty, create a new arena. */
@@ -143,6 +276,7 @@ malloc (size_t size)
           struct block *b = arena_to_block (a, i);
           list_push_back (&d->free_list, &b->free_elem);
         }
+      COUNT_ARENAS (&d->stats, 1);
     }
 
   /* Get a block from free list and return it. */
@@ -150,9 +284,18 @@ malloc (size_t size)
   a = block_to_arena (b);
   a->free_cnt--;
   lock_release (&d->lock);
+  COUNT_ALLOC (&d->stats, size, d->block_size, caller);
   return b;
 }
 
+/* Obtains and returns a new block of at least SIZE bytes.
+   Returns a null pointer if memory is not available. */
+void *
+malloc (size_t size) 
+{
+  return allocate (size, __builtin_return_address (0));
+}
+
 /* Allocates and return A times B bytes initialized to zeroes.
    Returns a null pointer if memory is not available. */
 void *
@@ -167,13 +310,25 @@ calloc (size_t a, size_t b)
     return NULL;
 
   /* Allocate and zero memory. */
-  p = malloc (size);
+  p = allocate (size, __builtin_return_address (0));
   if (p != NULL)
     memset (p, 0, size);
 
   return p;
 }
 
+/* Returns the number of bytes that malloc() sets aside for a
+   SIZE-byte request, not counting arena headers. */
+size_t
+malloc_block_size (size_t size) 
+{
+  struct desc *d = size_to_desc (size);
+
+  if (d != NULL)
+    return d->block_size;
+  return PGSIZE * DIV_ROUND_UP (size + sizeof (struct arena), PGSIZE);
+}
+
 /* Returns the number of bytes allocated for BLOCK. */
 static size_t
 block_size (void *block) 
@@ -185,6 +340,46 @@ block_size (void *block)
   return d != NULL ? d->block_size : PGSIZE * a->free_cnt - pg_ofs (block);
 }
 
+/* Tries to resize OLD_BLOCK to NEW_SIZE bytes without moving
+   it, for the function that will return to CALLER, and returns
+   true if successful.  A block stays put if NEW_SIZE fits and
+   would not fit a much smaller block.  A big block also shrinks
+   by giving back its last pages, or grows by taking the pages
+   after it if they are free; a size-class block never grows.  The statistics count a resize as
+   a free and an allocation. */
+static bool
+resize_in_place (void *old_block, size_t new_size, void *caller UNUSED) 
+{
+  struct arena *a = block_to_arena (old_block);
+  size_t page_cnt;
+
+  if (a->desc != NULL)
+    {
+      struct desc *d = a->desc;
+
+      if (new_size > d->block_size || new_size <= d->block_size / 2)
+        return false;
+      COUNT_FREE (&d->stats, d->block_size);
+      COUNT_ALLOC (&d->stats, new_size, d->block_size, caller);
+      return true;
+    }
+
+  if (size_to_desc (new_size) != NULL)
+    return false;
+  page_cnt = DIV_ROUND_UP (new_size + sizeof *a, PGSIZE);
+  if (page_cnt < a->free_cnt)
+    palloc_free_multiple ((uint8_t *) a + page_cnt * PGSIZE,
+                          a->free_cnt - page_cnt);
+  else if (page_cnt > a->free_cnt
+           && !palloc_extend (a, a->free_cnt, page_cnt))
+    return false;
+  COUNT_FREE (&big_stats, PGSIZE * a->free_cnt);
+  COUNT_ALLOC (&big_stats, new_size, PGSIZE * page_cnt, caller);
+  COUNT_ARENAS (&big_stats, (int) page_cnt - (int) a->free_cnt);
+  a->free_cnt = page_cnt;
+  return true;
+}
+
 /* Attempts to resize OLD_BLOCK to NEW_SIZE bytes, possibly
    moving it in the process.
    If successful, returns the new block; on failure, returns a
@@ -199,9 +394,13 @@ realloc (void *old_block, size_t new_size)
       free (old_block);
       return NULL;
     }
+  else if (old_block != NULL
+           && resize_in_place (old_block, new_size,
+                               __builtin_return_address (0)))
+    return old_block;
   else 
     {
-      void *new_block = malloc (new_size);
+      void *new_block = allocate (new_size, __builtin_return_address (0));
       if (old_block != NULL && new_block != NULL)
         {
           size_t old_size = block_size (old_block);
@@ -227,42 +426,106 @@ free (void *p)
       if (d != NULL) 
         {
           /* It's a normal block.  We handle it here. */
+          struct block *flush[MAG_SIZE / 2];
+          enum intr_level old_level;
+          size_t i;
 
 #ifndef NDEBUG
           /* Clear the block to help detect use-after-free bugs. */
           memset (b, 0xcc, d->block_size);
 #endif
-  
-          lock_acquire (&d->lock);
-
-          /* Add block to free list. */
-          list_push_front (&d->free_list, &b->free_elem);
+          COUNT_FREE (&d->stats, d->block_size);
 
-          /* If the arena is now entirely unused, free it. */
-          if (++a->free_cnt >= d->blocks_per_arena) 
+          /* Fast path: put the block in the magazine.  If it is
+             full, take half of it out to return to the free list
+             along with the block. */
+          old_level = intr_disable ();
+          if (d->mag_cnt < MAG_SIZE)
             {
-              size_t i;
-
-              ASSERT (a->free_cnt == d->blocks_per_arena);
-              for (i = 0; i < d->blocks_per_arena; i++) 
-                {
-                  struct block *b = arena_to_block (a, i);
-                  list_remove (&b->free_elem);
-                }
-              palloc_free_page (a);
+              d->mag[d->mag_cnt++] = b;
+              intr_set_level (old_level);
+              return;
             }
-
+          d->mag_cnt -= MAG_SIZE / 2;
+          memcpy (flush, d->mag + d->mag_cnt, sizeof flush);
+          intr_set_level (old_level);
+  
+          lock_acquire (&d->lock);
+          release_block (d, b);
+          for (i = 0; i < MAG_SIZE / 2; i++)
+            release_block (d, flush[i]);
           lock_release (&d->lock);
         }
       else
         {
           /* It's a big block.  Free its pages. */
+          COUNT_FREE (&big_stats, PGSIZE * a->free_cnt);
+          COUNT_ARENAS (&big_stats, -(int) a->free_cnt);
           palloc_free_multiple (a, a->free_cnt);
           return;
         }
     }
 }
 
+/* Adds block B to descriptor D's free list.  If the arena that B
+   is in is then entirely unused, frees it and returns true;
+   otherwise, returns false.  D's lock must be held. */
+static bool
+release_block (struct desc *d, struct block *b) 
+{
+  struct arena *a = block_to_arena (b);
+
+  /* Add block to free list. */
+  list_push_front (&d->free_list, &b->free_elem);
+
+  /* If the arena is now entirely unused, free it. */
+  if (++a->free_cnt >= d->blocks_per_arena) 
+    {
+      size_t i;
+
+      ASSERT (a->free_cnt == d->blocks_per_arena);
+      for (i = 0; i < d->blocks_per_arena; i++) 
+        {
+          struct block *b = arena_to_block (a, i);
+          list_remove (&b->free_elem);
+        }
+      palloc_free_page (a);
+      COUNT_ARENAS (&d->stats, -1);
+      return true;
+    }
+  return false;
+}
+
+/* Empties every magazine whose descriptor's lock is free into
+   its free list, and returns the number of arenas freed as a
+   result.  Called by the page allocator when it runs out of
+   kernel pages, possibly from malloc() with a descriptor's lock
+   held, so it must not wait for a descriptor lock. */
+static size_t
+malloc_reclaim (void) 
+{
+  size_t freed = 0;
+  struct desc *d;
+
+  for (d = descs; d < descs + desc_cnt; d++)
+    if (!lock_held_by_current_thread (&d->lock)
+        && lock_try_acquire (&d->lock))
+      {
+        for (;;)
+          {
+            enum intr_level old_level = intr_disable ();
+            struct block *b = d->mag_cnt > 0 ? d->mag[--d->mag_cnt] : NULL;
+            intr_set_level (old_level);
+
+            if (b == NULL)
+              break;
+            freed += release_block (d, b);
+          }
+        lock_release (&d->lock);
+      }
+  return freed;
+}
+
 /* Returns the arena that block B is inside. */
 static struct arena *
 block_to_arena (struct block *b)
@@ -292,3 +555,147 @@ arena_to_block (struct arena *a, size_t idx)
                            + sizeof *a
                            + idx * a->desc->block_size);
 }
+
+#ifdef ALLOC_STATS
+/* Counts a block of BYTES bytes, for a SIZE-byte request, as
+   allocated in S, by the function that will return to CALLER. */
+static void
+count_alloc (struct malloc_stats *s, size_t size, size_t bytes,
+             void *caller) 
+{
+  enum intr_level old_level = intr_disable ();
+
+  s->live++;
+  s->live_bytes += bytes;
+  if (s->live > s->peak)
+    s->peak = s->live;
+  if (s->live_bytes > s->peak_bytes)
+    s->peak_bytes = s->live_bytes;
+  s->allocs++;
+  s->requested += size;
+  s->reserved += bytes;
+
+  if (malloc_sites)
+    {
+      size_t h = ((uintptr_t) caller >> 2) % SITE_CNT;
+      size_t i;
+
+      for (i = 0; i < SITE_CNT; i++, h = (h + 1) % SITE_CNT)
+        if (sites[h].caller == caller || sites[h].caller == NULL)
+          {
+            sites[h].caller = caller;
+            sites[h].allocs++;
+            sites[h].bytes += size;
+            break;
+          }
+      if (i == SITE_CNT)
+        site_overflows++;
+    }
+  intr_set_level (old_level);
+}
+
+/* Counts a block of BYTES bytes as freed in S. */
+static void
+count_free (struct malloc_stats *s, size_t bytes) 
+{
+  enum intr_level old_level = intr_disable ();
+
+  ASSERT (s->live > 0 && s->live_bytes >= bytes);
+  s->live--;
+  s->live_bytes -= bytes;
+  intr_set_level (old_level);
+}
+
+/* Adds DELTA to the number of arenas in S. */
+static void
+count_arenas (struct malloc_stats *s, int delta) 
+{
+  enum intr_level old_level = intr_disable ();
+
+  s->arenas += delta;
+  if (s->arenas > s->peak_arenas)
+    s->peak_arenas = s->arenas;
+  intr_set_level (old_level);
+}
+
+/* Stores the statistics of the size class that serves SIZE-byte
+   requests, or of big blocks if SIZE is too big for any class,
+   into *STATS. */
+void
+malloc_get_stats (size_t size, struct malloc_stats *stats) 
+{
+  struct desc *d = size_to_desc (size);
+  enum intr_level old_level = intr_disable ();
+
+  *stats = d != NULL ? d->stats : big_stats;
+  intr_set_level (old_level);
+}
+
+/* Returns the share of RESERVED bytes that were not REQUESTED,
+   in per mille. */
+static unsigned
+waste (unsigned long long requested, unsigned long long reserved) 
+{
+  return reserved > 0 ? (reserved - requested) * 1000 / reserved : 0;
+}
+
+/* Prints each size class's statistics: blocks and bytes in use
+   now and at peak, arenas now and at peak, the share of arena
+   blocks not in use ("idle"), and the share of bytes ever set
+   aside that were not requested ("waste"), both in per mille.
+   Then prints the totals by call site, if they were counted. */
+void
+malloc_print_stats (void) 
+{
+  size_t live_bytes = 0, arena_bytes = 0;
+  struct malloc_stats s;
+  size_t i;
+
+  printf ("Malloc: class   live   peak  live_kB  peak_kB arenas  peak "
+          "idle waste allocs\n");
+  for (i = 0; i <= desc_cnt; i++)
+    {
+      size_t capacity;
+
+      if (i < desc_cnt)
+        {
+          malloc_get_stats (descs[i].block_size, &s);
+          capacity = s.arenas * descs[i].blocks_per_arena;
+          arena_bytes += s.arenas * PGSIZE;
+        }
+      else
+        {
+          /* A big block's pages are all in use. */
+          malloc_get_stats (MAX_CLASS_SIZE + 1, &s);
+          capacity = 0;
+          arena_bytes += s.arenas * PGSIZE;
+        }
+      live_bytes += s.live_bytes;
+      if (s.allocs == 0)
+        continue;
+
+      if (i < desc_cnt)
+        printf ("%14zu", s.block_size);
+      else
+        printf ("%14s", "big");
+      printf (" %6zu %6zu %8zu %8zu %6zu %5zu %4zu %5u %llu\n",
+              s.live, s.peak, s.live_bytes / 1024, s.peak_bytes / 1024,
+              s.arenas, s.peak_arenas,
+              capacity > 0 ? (capacity - s.live) * 1000 / capacity : 0,
+              waste (s.requested, s.reserved), s.allocs);
+    }
+  printf ("Malloc: %zu kB in use in %zu kB of pages\n",
+          live_bytes / 1024, arena_bytes / 1024);
+
+  if (malloc_sites)
+    {
+      printf ("Malloc call sites:     allocs      bytes\n");
+      for (i = 0; i < SITE_CNT; i++)
+        if (sites[i].caller != NULL)
+          printf ("%18p %10u %10llu\n",
+                  sites[i].caller, sites[i].allocs, sites[i].bytes);
+      if (site_overflows > 0)
+        printf ("%18s %10u\n", "(table full)", site_overflows);
+    }
+}
+#endif /* ALLOC_STATS */
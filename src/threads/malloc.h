@@ -2,6 +2,7 @@
 #define THREADS_MALLOC_H
 
 #include <debug.h>
+#include <stdbool.h>
 #include <stddef.h>
 
 void malloc_init (void);
@@ -9,5 +10,32 @@ void *malloc (size_t) __attribute__ ((malloc));
 void *calloc (size_t, size_t) __attribute__ ((malloc));
 void *realloc (void *, size_t);
 void free (void *);
+size_t malloc_block_size (size_t);
+
+#ifdef ALLOC_STATS
+/* Allocation statistics for one size class, or for the blocks
+   too big for any class, from malloc_get_stats().  Only in
+   kernels built with "make ALLOC_STATS=1". */
+struct malloc_stats
+  {
+    size_t block_size;          /* Bytes per block, or 0 if big. */
+    size_t live;                /* Blocks in use. */
+    size_t peak;                /* Most blocks in use at once. */
+    size_t live_bytes;          /* Bytes in blocks in use. */
+    size_t peak_bytes;          /* Most bytes in use at once. */
+    size_t arenas;              /* Arenas; pages if big. */
+    size_t peak_arenas;         /* Most arenas at once. */
+    unsigned long long allocs;  /* Blocks ever allocated. */
+    unsigned long long requested; /* Bytes ever requested. */
+    unsigned long long reserved; /* Bytes ever set aside for them. */
+  };
+
+/* If true, count allocations by calling function too.  Set by
+   kernel option -allocsites. */
+extern bool malloc_sites;
+
+void malloc_get_stats (size_t size, struct malloc_stats *);
+void malloc_print_stats (void);
+#endif
 
 #endif /* threads/malloc.h */
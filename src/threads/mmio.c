@@ -0,0 +1,48 @@
+#include "threads/mmio.h"
+#include <debug.h>
+#include "threads/init.h"
+#include "threads/palloc.h"
+#include "threads/pte.h"
+#include "threads/vaddr.h"
+
+/* The window is the last 4 MB of virtual memory, which one page
+   table covers.  Pages are handed out from the bottom up and
+   never unmapped. */
+#define MMIO_BASE ((uint8_t *) 0xffc00000)
+#define MMIO_PAGES (PGSIZE / sizeof (uint32_t))
+
+static uint32_t *mmio_pt;       /* Page table for the window. */
+static size_t mmio_used;        /* Pages of the window in use. */
+
+/* Maps the page of device memory that contains physical address
+   PADDR into kernel virtual memory, with caching disabled, and
+   returns the virtual address that corresponds to PADDR.  Mapping
+   the same page twice returns the same address.
+
+   Must be called after paging_init(), and before any user process
+   is created, because process page directories copy the kernel's
+   page directory entries when they are created. */
+void *
+mmio_map (uintptr_t paddr)
+{
+  uintptr_t page = paddr & PTE_ADDR;
+  size_t i;
+
+  ASSERT (init_page_dir != NULL);
+
+  if (mmio_pt == NULL)
+    {
+      mmio_pt = palloc_get_page (PAL_ASSERT | PAL_ZERO);
+      init_page_dir[pd_no (MMIO_BASE)] = pde_create (mmio_pt);
+    }
+
+  for (i = 0; i < mmio_used; i++)
+    if ((mmio_pt[i] & PTE_ADDR) == page)
+      return MMIO_BASE + i * PGSIZE + pg_ofs ((void *) paddr);
+
+  if (mmio_used >= MMIO_PAGES)
+    PANIC ("out of memory-mapped I/O space");
+  i = mmio_used++;
+  mmio_pt[i] = page | PTE_PCD | PTE_PWT | PTE_W | PTE_P;
+  return MMIO_BASE + i * PGSIZE + pg_ofs ((void *) paddr);
+}
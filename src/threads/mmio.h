@@ -0,0 +1,30 @@
+#ifndef THREADS_MMIO_H
+#define THREADS_MMIO_H
+
+#include <stdint.h>
+
+/* Memory-mapped device registers.
+
+   Devices such as the local and I/O APICs have their registers at
+   physical addresses far above RAM, which the kernel's mapping of
+   physical memory at PHYS_BASE does not cover.  mmio_map() maps
+   such pages, uncached, into a window at the top of the kernel
+   address space. */
+
+void *mmio_map (uintptr_t paddr);
+
+/* Reads the 32-bit device register at ADDR. */
+static inline uint32_t
+mmio_read32 (volatile void *addr)
+{
+  return *(volatile uint32_t *) addr;
+}
+
+/* Writes DATA to the 32-bit device register at ADDR. */
+static inline void
+mmio_write32 (volatile void *addr, uint32_t data)
+{
+  *(volatile uint32_t *) addr = data;
+}
+
+#endif /* threads/mmio.h */
@@ -0,0 +1,287 @@
+#include "threads/mp.h"
+#include <debug.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/vaddr.h"
+
+/* MP floating pointer structure, which locates the configuration
+   table.  See [MP] 4.1. */
+struct mp_float
+  {
+    char signature[4];          /* "_MP_". */
+    uint32_t config;            /* Physical address of config table. */
+    uint8_t length;             /* Length in 16-byte units. */
+    uint8_t spec_rev;           /* Specification revision. */
+    uint8_t checksum;           /* All bytes sum to zero. */
+    uint8_t features[5];        /* Feature bytes; [0] is a default
+                                   configuration number, if nonzero. */
+  }
+__attribute__ ((packed));
+#define MPF_IMCRP 0x80          /* In features[1]: IMCR present. */
+
+/* MP configuration table header.  See [MP] 4.2. */
+struct mp_config
+  {
+    char signature[4];          /* "PCMP". */
+    uint16_t length;            /* Length of base table in bytes. */
+    uint8_t spec_rev;           /* Specification revision. */
+    uint8_t checksum;           /* All bytes sum to zero. */
+    char oem_id[8];             /* OEM identifier. */
+    char product_id[12];        /* Product identifier. */
+    uint32_t oem_table;         /* OEM table address, or 0. */
+    uint16_t oem_table_size;    /* OEM table size. */
+    uint16_t entry_cnt;         /* Number of entries after header. */
+    uint32_t lapic_addr;        /* Physical address of local APICs. */
+    uint16_t ext_length;        /* Extended table length. */
+    uint8_t ext_checksum;       /* Extended table checksum. */
+    uint8_t reserved;
+  }
+__attribute__ ((packed));
+
+/* Configuration table entry types.  See [MP] 4.3. */
+enum mp_entry_type
+  {
+    MP_PROCESSOR = 0,           /* 20 bytes. */
+    MP_BUS = 1,                 /* 8 bytes. */
+    MP_IOAPIC = 2,              /* 8 bytes. */
+    MP_IOINTR = 3,              /* 8 bytes. */
+    MP_LINTR = 4                /* 8 bytes. */
+  };
+
+/* Processor entry. */
+struct mp_processor
+  {
+    uint8_t type;               /* MP_PROCESSOR. */
+    uint8_t apic_id;            /* Local APIC ID. */
+    uint8_t apic_version;       /* Local APIC version. */
+    uint8_t flags;              /* MPP_* flags. */
+    uint32_t signature;         /* CPU signature. */
+    uint32_t features;          /* CPUID feature flags. */
+    uint32_t reserved[2];
+  }
+__attribute__ ((packed));
+#define MPP_ENABLED 0x01        /* Processor is usable. */
+
+/* Bus entry. */
+struct mp_bus
+  {
+    uint8_t type;               /* MP_BUS. */
+    uint8_t bus_id;             /* Bus identifier. */
+    char bus_type[6];           /* "ISA   ", "PCI   ", ... */
+  }
+__attribute__ ((packed));
+
+/* I/O APIC entry. */
+struct mp_ioapic
+  {
+    uint8_t type;               /* MP_IOAPIC. */
+    uint8_t apic_id;            /* I/O APIC ID. */
+    uint8_t apic_version;       /* I/O APIC version. */
+    uint8_t flags;              /* Bit 0: usable. */
+    uint32_t addr;              /* Physical address. */
+  }
+__attribute__ ((packed));
+
+/* I/O interrupt assignment entry. */
+struct mp_iointr
+  {
+    uint8_t type;               /* MP_IOINTR. */
+    uint8_t intr_type;          /* 0: vectored interrupt. */
+    uint16_t flags;             /* Polarity in bits 0-1, trigger in 2-3. */
+    uint8_t src_bus;            /* Source bus ID. */
+    uint8_t src_irq;            /* Source bus IRQ. */
+    uint8_t dst_apic;           /* Destination I/O APIC ID. */
+    uint8_t dst_pin;            /* Destination I/O APIC input. */
+  }
+__attribute__ ((packed));
+
+int mp_cpu_cnt;
+uintptr_t mp_lapic_addr;
+uintptr_t mp_ioapic_addr;
+uint8_t mp_ioapic_id;
+struct mp_irq mp_isa_irqs[MP_ISA_IRQS];
+
+/* True if the machine starts up in PIC mode, with an interrupt
+   mode configuration register (IMCR) that connects the 8259s
+   directly to the bootstrap processor, bypassing the APICs.  See
+   [MP] 3.6.2.1. */
+bool mp_imcr;
+
+static bool checksum_ok (const void *, size_t);
+static const struct mp_float *search (uintptr_t paddr, size_t size);
+static const struct mp_float *find_float (void);
+static void parse_config (const struct mp_config *);
+
+/* Finds and parses the MP configuration table.  Returns true if
+   successful, false if the machine has none, in which case it is
+   a uniprocessor with only the legacy 8259 interrupt
+   controller.  Only the first I/O APIC is used. */
+bool
+mp_init (void)
+{
+  const struct mp_float *mpf = find_float ();
+  const struct mp_config *conf;
+  int i;
+
+  if (mpf == NULL)
+    return false;
+
+  /* Default configurations ([MP] chapter 5) describe two
+     processors with fixed APIC addresses and no table. */
+  if (mpf->features[0] != 0 || mpf->config == 0)
+    {
+      printf ("mp: default configuration %d not supported\n",
+              mpf->features[0]);
+      return false;
+    }
+
+  /* The table must be in memory that the kernel maps. */
+  if (mpf->config >= 1024 * 1024)
+    {
+      printf ("mp: configuration table at %#"PRIx32" not mapped\n",
+              mpf->config);
+      return false;
+    }
+  conf = ptov (mpf->config);
+  if (memcmp (conf->signature, "PCMP", 4) || !checksum_ok (conf, conf->length))
+    {
+      printf ("mp: bad configuration table\n");
+      return false;
+    }
+
+  mp_imcr = (mpf->features[1] & MPF_IMCRP) != 0;
+
+  /* ISA interrupts default to the I/O APIC pin of the same number,
+     edge-triggered and active high. */
+  for (i = 0; i < MP_ISA_IRQS; i++)
+    {
+      mp_isa_irqs[i].pin = i;
+      mp_isa_irqs[i].active_low = false;
+      mp_isa_irqs[i].level = false;
+    }
+
+  parse_config (conf);
+  return mp_cpu_cnt > 0 && mp_lapic_addr != 0;
+}
+
+/* Records the entries of configuration table CONF. */
+static void
+parse_config (const struct mp_config *conf)
+{
+  const uint8_t *p = (const uint8_t *) (conf + 1);
+  const uint8_t *end = (const uint8_t *) conf + conf->length;
+  int isa_bus = -1;
+  int i;
+
+  mp_lapic_addr = conf->lapic_addr;
+  for (i = 0; i < conf->entry_cnt && p < end; i++)
+    switch (*p)
+      {
+      case MP_PROCESSOR:
+        {
+          const struct mp_processor *proc = (const void *) p;
+          if (proc->flags & MPP_ENABLED)
+            mp_cpu_cnt++;
+          p += sizeof *proc;
+        }
+        break;
+
+      case MP_BUS:
+        {
+          const struct mp_bus *bus = (const void *) p;
+          if (!memcmp (bus->bus_type, "ISA", 3))
+            isa_bus = bus->bus_id;
+          p += sizeof *bus;
+        }
+        break;
+
+      case MP_IOAPIC:
+        {
+          const struct mp_ioapic *ioapic = (const void *) p;
+          if ((ioapic->flags & 1) && mp_ioapic_addr == 0)
+            {
+              mp_ioapic_id = ioapic->apic_id;
+              mp_ioapic_addr = ioapic->addr;
+            }
+          p += sizeof *ioapic;
+        }
+        break;
+
+      case MP_IOINTR:
+        {
+          /* Bus entries precede interrupt entries, so the ISA bus
+             is known by now.  Polarity and trigger values of 0
+             mean "conforms to the bus", which for ISA is active
+             high and edge-triggered. */
+          const struct mp_iointr *intr = (const void *) p;
+          if (intr->intr_type == 0 && intr->src_bus == isa_bus
+              && intr->src_irq < MP_ISA_IRQS
+              && intr->dst_apic == mp_ioapic_id)
+            {
+              struct mp_irq *irq = &mp_isa_irqs[intr->src_irq];
+              irq->pin = intr->dst_pin;
+              irq->active_low = (intr->flags & 3) == 3;
+              irq->level = ((intr->flags >> 2) & 3) == 3;
+            }
+          p += sizeof *intr;
+        }
+        break;
+
+      case MP_LINTR:
+        p += 8;
+        break;
+
+      default:
+        /* Unknown entry type: its length is unknown, too. */
+        printf ("mp: unknown configuration entry type %d\n", *p);
+        return;
+      }
+}
+
+/* Returns true if the SIZE bytes at P sum to zero, modulo 256. */
+static bool
+checksum_ok (const void *p_, size_t size)
+{
+  const uint8_t *p = p_;
+  uint8_t sum = 0;
+
+  while (size-- > 0)
+    sum += *p++;
+  return sum == 0;
+}
+
+/* Searches the SIZE bytes of physical memory at PADDR for an MP
+   floating pointer structure and returns it, or a null pointer
+   if there is none. */
+static const struct mp_float *
+search (uintptr_t paddr, size_t size)
+{
+  const uint8_t *p = ptov (paddr);
+  const uint8_t *end = p + size;
+
+  for (; p + sizeof (struct mp_float) <= end; p += 16)
+    if (!memcmp (p, "_MP_", 4) && checksum_ok (p, sizeof (struct mp_float)))
+      return (const struct mp_float *) p;
+  return NULL;
+}
+
+/* Finds the MP floating pointer structure in one of the places
+   that [MP] 4 allows: the first kB of the extended BIOS data
+   area, the last kB of base memory, or the BIOS ROM. */
+static const struct mp_float *
+find_float (void)
+{
+  const uint8_t *bda = ptov (0x400);
+  uintptr_t ebda = ((bda[0x0f] << 8) | bda[0x0e]) << 4;
+  uintptr_t base_kb = (bda[0x14] << 8) | bda[0x13];
+  const struct mp_float *mpf = NULL;
+
+  if (ebda != 0)
+    mpf = search (ebda, 1024);
+  if (mpf == NULL && base_kb != 0)
+    mpf = search (base_kb * 1024 - 1024, 1024);
+  if (mpf == NULL)
+    mpf = search (0xf0000, 0x10000);
+  return mpf;
+}
@@ -0,0 +1,32 @@
+#ifndef THREADS_MP_H
+#define THREADS_MP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Intel MultiProcessor Specification configuration tables, which
+   the BIOS uses to describe the processors, local and I/O APICs,
+   and interrupt routing of the machine.  See [MP] chapter 4. */
+
+/* Number of ISA interrupt lines. */
+#define MP_ISA_IRQS 16
+
+/* Routing of an ISA interrupt line to an I/O APIC input. */
+struct mp_irq
+  {
+    int pin;                    /* I/O APIC input pin. */
+    bool active_low;            /* Polarity: true if active low. */
+    bool level;                 /* Trigger: true if level, false if edge. */
+  };
+
+/* Machine configuration, valid if mp_init() returned true. */
+extern int mp_cpu_cnt;
+extern uintptr_t mp_lapic_addr;
+extern uintptr_t mp_ioapic_addr;
+extern uint8_t mp_ioapic_id;
+extern struct mp_irq mp_isa_irqs[MP_ISA_IRQS];
+extern bool mp_imcr;
+
+bool mp_init (void);
+
+#endif /* threads/mp.h */
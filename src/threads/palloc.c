@@ -2,13 +2,17 @@
 #include <bitmap.h>
 #include <debug.h>
 #include <inttypes.h>
+#include <list.h>
 #include <round.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include "threads/interrupt.h"
 #include "threads/loader.h"
+#include "threads/malloc.h"
 #include "threads/synch.h"
+#include "threads/thread.h"
 #include "threads/vaddr.h"
 
 /* Page allocator.  Hands out memory in page-size (or
@@ -23,22 +27,105 @@
 
    By default, half of system RAM is given to the kernel pool and
    half to the user pool.  That should be huge overkill for the
-   kernel pool, but that's just fine for demonstration purposes. */
+   kernel pool, but that's just fine for demonstration purposes.
+
+   Within a pool, free pages are managed by a binary buddy
+   allocator.  The free pages form blocks of 2**ORDER pages whose
+   index within the pool is a multiple of 2**ORDER, kept on one
+   free list per order.  A request for N pages takes the smallest
+   free block of at least N pages, splitting larger blocks in
+   halves as needed, and returns the unneeded tail of the block
+   to the free lists.  A freed range is broken into aligned
+   blocks, each of which is merged with its "buddy", the other
+   half of the next larger block, for as long as the buddy is
+   free.  Both take O(log n) time in the size of the pool, short
+   enough to run with interrupts off, so that pages may be freed
+   from within the scheduler.
+
+   The kernel option -palloc=bitmap instead selects the original
+   first-fit scan of the pool's used_map, for comparison.
+
+   Each pool also keeps a small stock of pages that are already
+   filled with zeros, so that a single-page PAL_ZERO request does
+   not have to clear a page in the caller's critical path.  The
+   idle thread takes free pages out of the pools and clears them,
+   one at a time, whenever no other thread is ready to run, so
+   zeroing never takes CPU time from a thread under any scheduler.
+   The stock pages count as allocated.  They go back to the pool
+   when an allocation would otherwise fail, and the idle thread
+   stops refilling a pool that is running short of free pages.
+
+   In a kernel built with "make ALLOC_STATS=1", each pool also
+   counts the most pages it ever had in use and the allocations
+   it failed, and an allocation that panics for lack of pages
+   first prints those and malloc()'s statistics. */
+
+/* If true, allocate by first-fit scan instead of buddy system. */
+bool palloc_bitmap;
+
+/* Number of buddy block orders.  Enough for any pool. */
+#define BUDDY_ORDERS 32
+
+/* Most pre-zeroed pages to keep per pool. */
+#define ZERO_STOCK_MAX 32
 
 /* A memory pool. */
 struct pool
   {
-    struct lock lock;                   /* Mutual exclusion. */
+    struct lock lock;                   /* Serializes bitmap scans. */
     struct bitmap *used_map;            /* Bitmap of free pages. */
     uint8_t *base;                      /* Base of pool. */
+    size_t page_cnt;                    /* Number of pages in pool. */
+    size_t free_cnt;                    /* Number of free pages. */
+
+    /* Buddy allocator. */
+    uint8_t *free_order;                /* 1 + order of the free block
+                                           starting at each page, or 0. */
+    struct list free_lists[BUDDY_ORDERS]; /* Free blocks of each order. */
+
+    /* Pre-zeroed pages.  The stock is accessed with interrupts
+       off. */
+    void *zero_pages[ZERO_STOCK_MAX];   /* Stock of zeroed pages. */
+    size_t zero_cnt;                    /* Number of pages in stock. */
+    unsigned zero_hits;                 /* PAL_ZERO pages from stock. */
+    unsigned zero_misses;               /* PAL_ZERO pages not in stock. */
+    unsigned zero_background;           /* Pages zeroed while idle. */
+
+#ifdef ALLOC_STATS
+    /* Accessed with interrupts off. */
+    size_t peak_used;                   /* Most pages in use at once. */
+    unsigned failures;                  /* Allocations that failed. */
+#endif
+  };
+
+/* A free buddy block, stored in the block's first page. */
+struct free_block
+  {
+    struct list_elem elem;              /* Element in a free list. */
   };
 
 /* Two pools: one for kernel data, one for user pages. */
 static struct pool kernel_pool, user_pool;
 
+/* Functions that free cached kernel pages under memory
+   pressure. */
+#define RECLAIM_MAX 4
+static palloc_reclaim_func *reclaim_funcs[RECLAIM_MAX];
+static int reclaim_cnt;
+
 static void init_pool (struct pool *, void *base, size_t page_cnt,
                        const char *name);
 static bool page_from_pool (const struct pool *, void *page);
+static void *scan_pool (struct pool *, size_t page_cnt);
+static size_t buddy_alloc (struct pool *, size_t page_cnt);
+static void buddy_free (struct pool *, size_t page_idx, size_t page_cnt);
+static void buddy_claim (struct pool *, size_t page_idx, size_t page_cnt);
+static size_t reclaim (void);
+static void free_pages (struct pool *, size_t page_idx, size_t page_cnt);
+static void note_used (struct pool *);
+static void *take_zero_page (struct pool *);
+static size_t drain_zero_stock (struct pool *);
+static bool zero_one_page (struct pool *);
 
 /* Initializes the page allocator.  At most USER_PAGE_LIMIT
    pages are put into the user pool. */
@@ -66,25 +153,36 @@ palloc_init (size_t user_page_limit)
    otherwise from the kernel pool.  If PAL_ZERO is set in FLAGS,
    then the pages are filled with zeros.  If too few pages are
    available, returns a null pointer, unless PAL_ASSERT is set in
-   FLAGS, in which case the kernel panics. */
+   FLAGS, in which case the kernel panics.  A single PAL_ZERO
+   page comes from the pool's stock of pre-zeroed pages if it has
+   any.  Before giving up, returns that stock to the pool and, for
+   the kernel pool, asks the registered reclaim functions to free
+   the pages they cache. */
 void *
 palloc_get_multiple (enum palloc_flags flags, size_t page_cnt)
 {
   struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
   void *pages;
-  size_t page_idx;
 
   if (page_cnt == 0)
     return NULL;
 
-  lock_acquire (&pool->lock);
-  page_idx = bitmap_scan_and_flip (pool->used_map, 0, page_cnt, false);
-  lock_release (&pool->lock);
+  if ((flags & PAL_ZERO) && page_cnt == 1)
+    {
+      pages = take_zero_page (pool);
+      if (pages != NULL)
+        return pages;
+    }
 
-  if (page_idx != BITMAP_ERROR)
-    pages = pool->base + PGSIZE * page_idx;
-  else
-    pages = NULL;
+  pages = scan_pool (pool, page_cnt);
+  if (pages == NULL)
+    {
+      size_t freed = drain_zero_stock (pool);
+      if (pool == &kernel_pool)
+        freed += reclaim ();
+      if (freed > 0)
+        pages = scan_pool (pool, page_cnt);
+    }
 
   if (pages != NULL) 
     {
@@ -93,6 +191,16 @@ palloc_get_multiple (enum palloc_flags flags, size_t page_cnt)
     }
   else 
     {
+#ifdef ALLOC_STATS
+      enum intr_level old_level = intr_disable ();
+      pool->failures++;
+      intr_set_level (old_level);
+      if (flags & PAL_ASSERT)
+        {
+          palloc_print_stats ();
+          malloc_print_stats ();
+        }
+#endif
       if (flags & PAL_ASSERT)
         PANIC ("palloc_get: out of pages");
     }
@@ -137,8 +245,7 @@ palloc_free_multiple (void *pages, size_t page_cnt)
   memset (pages, 0xcc, PGSIZE * page_cnt);
 #endif
 
-  ASSERT (bitmap_all (pool->used_map, page_idx, page_cnt));
-  bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+  free_pages (pool, page_idx, page_cnt);
 }
 
 /* Frees the page at PAGE. */
@@ -148,15 +255,460 @@ palloc_free_page (void *page)
   palloc_free_multiple (page, 1);
 }
 
+/* Tries to grow the PAGE_CNT pages starting at PAGES, obtained
+   from palloc_get_multiple(), to NEW_CNT pages by taking the
+   pages that follow them.  Returns true if successful, false if
+   any of those pages is in use or outside the pool. */
+bool
+palloc_extend (void *pages, size_t page_cnt, size_t new_cnt) 
+{
+  struct pool *pool;
+  enum intr_level old_level;
+  size_t page_idx, add_cnt;
+  bool success = false;
+
+  ASSERT (pg_ofs (pages) == 0);
+  ASSERT (new_cnt >= page_cnt);
+
+  if (page_from_pool (&kernel_pool, pages))
+    pool = &kernel_pool;
+  else if (page_from_pool (&user_pool, pages))
+    pool = &user_pool;
+  else
+    NOT_REACHED ();
+
+  page_idx = pg_no (pages) - pg_no (pool->base) + page_cnt;
+  add_cnt = new_cnt - page_cnt;
+  if (add_cnt == 0)
+    return true;
+  if (page_idx + add_cnt > pool->page_cnt)
+    return false;
+
+  /* A bitmap scan may be between testing and flipping bits. */
+  if (palloc_bitmap)
+    lock_acquire (&pool->lock);
+  old_level = intr_disable ();
+  if (bitmap_none (pool->used_map, page_idx, add_cnt))
+    {
+      if (!palloc_bitmap)
+        buddy_claim (pool, page_idx, add_cnt);
+      bitmap_set_multiple (pool->used_map, page_idx, add_cnt, true);
+      pool->free_cnt -= add_cnt;
+      note_used (pool);
+      success = true;
+    }
+  intr_set_level (old_level);
+  if (palloc_bitmap)
+    lock_release (&pool->lock);
+
+  return success;
+}
+
+/* Registers FUNC to be called when the kernel pool runs out of
+   pages. */
+void
+palloc_register_reclaim (palloc_reclaim_func *func)
+{
+  ASSERT (reclaim_cnt < RECLAIM_MAX);
+  reclaim_funcs[reclaim_cnt++] = func;
+}
+
+/* Stores statistics about the pool that FLAGS selects, as in
+   palloc_get_multiple(), into *STATS.  Takes time linear in the
+   size of the pool, with interrupts off. */
+void
+palloc_get_stats (enum palloc_flags flags, struct palloc_stats *stats)
+{
+  struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
+  enum intr_level old_level;
+  size_t run = 0;
+  size_t i;
+
+  stats->page_cnt = pool->page_cnt;
+  stats->free_cnt = 0;
+  stats->largest_free = 0;
+
+  old_level = intr_disable ();
+  stats->zero_stock = pool->zero_cnt;
+  stats->zero_hits = pool->zero_hits;
+  stats->zero_misses = pool->zero_misses;
+  stats->zero_background = pool->zero_background;
+  for (i = 0; i < pool->page_cnt; i++)
+    if (!bitmap_test (pool->used_map, i))
+      {
+        stats->free_cnt++;
+        if (++run > stats->largest_free)
+          stats->largest_free = run;
+      }
+    else
+      run = 0;
+  intr_set_level (old_level);
+}
+
+/* Prints the pre-zeroed page statistics of both pools, and
+   their usage if the kernel was built with ALLOC_STATS. */
+void
+palloc_print_stats (void)
+{
+  printf ("Zeroed pages: kernel %u hits, %u misses, %u in background; "
+          "user %u hits, %u misses, %u in background\n",
+          kernel_pool.zero_hits, kernel_pool.zero_misses,
+          kernel_pool.zero_background, user_pool.zero_hits,
+          user_pool.zero_misses, user_pool.zero_background);
+#ifdef ALLOC_STATS
+  printf ("Pages in use: kernel %zu of %zu, peak %zu, %u failures; "
+          "user %zu of %zu, peak %zu, %u failures\n",
+          kernel_pool.page_cnt - kernel_pool.free_cnt, kernel_pool.page_cnt,
+          kernel_pool.peak_used, kernel_pool.failures,
+          user_pool.page_cnt - user_pool.free_cnt, user_pool.page_cnt,
+          user_pool.peak_used, user_pool.failures);
+#endif
+}
+
+/* Marks PAGE_CNT contiguous free pages in POOL as used and
+   returns the first, or a null pointer if there are none. */
+static void *
+scan_pool (struct pool *pool, size_t page_cnt)
+{
+  enum intr_level old_level;
+  size_t page_idx;
+
+  if (palloc_bitmap)
+    {
+      lock_acquire (&pool->lock);
+      page_idx = bitmap_scan_and_flip (pool->used_map, 0, page_cnt, false);
+      lock_release (&pool->lock);
+
+      old_level = intr_disable ();
+    }
+  else
+    {
+      old_level = intr_disable ();
+      page_idx = buddy_alloc (pool, page_cnt);
+      if (page_idx != BITMAP_ERROR)
+        {
+          ASSERT (bitmap_none (pool->used_map, page_idx, page_cnt));
+          bitmap_set_multiple (pool->used_map, page_idx, page_cnt, true);
+        }
+    }
+  if (page_idx != BITMAP_ERROR)
+    {
+      pool->free_cnt -= page_cnt;
+      note_used (pool);
+    }
+  intr_set_level (old_level);
+
+  return page_idx != BITMAP_ERROR ? pool->base + PGSIZE * page_idx : NULL;
+}
+
+/* Records POOL's pages in use as its peak if they are the most
+   so far.  Interrupts must be off. */
+static void
+note_used (struct pool *pool UNUSED)
+{
+#ifdef ALLOC_STATS
+  size_t used = pool->page_cnt - pool->free_cnt;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+  if (used > pool->peak_used)
+    pool->peak_used = used;
+#endif
+}
+
+/* Returns the PAGE_CNT pages starting at PAGE_IDX to POOL. */
+static void
+free_pages (struct pool *pool, size_t page_idx, size_t page_cnt)
+{
+  enum intr_level old_level = intr_disable ();
+
+  ASSERT (bitmap_all (pool->used_map, page_idx, page_cnt));
+  bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+  if (!palloc_bitmap)
+    buddy_free (pool, page_idx, page_cnt);
+  pool->free_cnt += page_cnt;
+  intr_set_level (old_level);
+}
+
+/* Takes a page from POOL's stock of pre-zeroed pages and returns
+   it, or counts a miss and returns a null pointer if the stock
+   is empty. */
+static void *
+take_zero_page (struct pool *pool)
+{
+  enum intr_level old_level = intr_disable ();
+  void *page = NULL;
+
+  if (pool->zero_cnt > 0)
+    {
+      page = pool->zero_pages[--pool->zero_cnt];
+      pool->zero_hits++;
+    }
+  else
+    pool->zero_misses++;
+  intr_set_level (old_level);
+
+  return page;
+}
+
+/* Returns all of POOL's pre-zeroed pages to the pool, and returns
+   the number of pages returned. */
+static size_t
+drain_zero_stock (struct pool *pool)
+{
+  size_t drained = 0;
+
+  for (;;)
+    {
+      enum intr_level old_level = intr_disable ();
+      void *page = NULL;
+
+      if (pool->zero_cnt > 0)
+        page = pool->zero_pages[--pool->zero_cnt];
+      intr_set_level (old_level);
+
+      if (page == NULL)
+        return drained;
+      free_pages (pool, pg_no (page) - pg_no (pool->base), 1);
+      drained++;
+    }
+}
+
+/* Clears one page for the stocks of pre-zeroed pages, the kernel
+   pool's first, since page directories and stacks come from it.
+   Returns true if a page was added to a stock, false if every
+   stock is full or its pool has no free pages to spare.
+
+   Called only by the idle thread, with interrupts on, when no
+   other thread is ready to run.  Never sleeps. */
+bool
+palloc_zero_idle (void)
+{
+  return zero_one_page (&kernel_pool) || zero_one_page (&user_pool);
+}
+
+/* Adds a zeroed page to POOL's stock, unless the stock is full or
+   the pool has no more free pages to spare than the stock would
+   hold.  Returns true if a page was added.
+
+   The idle thread must not sleep, so in bitmap mode this gives up
+   instead of waiting while another thread holds the pool's lock.
+   The idle thread is never preempted, so no other thread can take
+   the lock during the scan. */
+static bool
+zero_one_page (struct pool *pool)
+{
+  enum intr_level old_level;
+  size_t page_idx;
+  void *page;
+
+  old_level = intr_disable ();
+  if (pool->zero_cnt >= ZERO_STOCK_MAX || pool->free_cnt <= ZERO_STOCK_MAX
+      || (palloc_bitmap && pool->lock.holder != NULL))
+    page_idx = BITMAP_ERROR;
+  else if (palloc_bitmap)
+    page_idx = bitmap_scan_and_flip (pool->used_map, 0, 1, false);
+  else
+    {
+      page_idx = buddy_alloc (pool, 1);
+      if (page_idx != BITMAP_ERROR)
+        {
+          ASSERT (!bitmap_test (pool->used_map, page_idx));
+          bitmap_mark (pool->used_map, page_idx);
+        }
+    }
+  if (page_idx != BITMAP_ERROR)
+    {
+      pool->free_cnt--;
+      note_used (pool);
+    }
+  intr_set_level (old_level);
+  if (page_idx == BITMAP_ERROR)
+    return false;
+
+  page = pool->base + PGSIZE * page_idx;
+  memset (page, 0, PGSIZE);
+
+  /* Only the idle thread adds to the stock, so there is still
+     room even if a page was taken meanwhile. */
+  old_level = intr_disable ();
+  pool->zero_pages[pool->zero_cnt++] = page;
+  pool->zero_background++;
+  intr_set_level (old_level);
+  return true;
+}
+
+/* Returns the free block header in the page with index PAGE_IDX
+   in POOL. */
+static struct free_block *
+block_at (struct pool *pool, size_t page_idx)
+{
+  return (struct free_block *) (pool->base + PGSIZE * page_idx);
+}
+
+/* Adds the block of 2**ORDER pages at PAGE_IDX to POOL's free
+   lists. */
+static void
+insert_block (struct pool *pool, size_t page_idx, int order)
+{
+  pool->free_order[page_idx] = order + 1;
+  list_push_front (&pool->free_lists[order], &block_at (pool, page_idx)->elem);
+}
+
+/* Removes the block of 2**ORDER pages at PAGE_IDX from POOL's
+   free lists. */
+static void
+remove_block (struct pool *pool, size_t page_idx, int order)
+{
+  ASSERT (pool->free_order[page_idx] == order + 1);
+
+  pool->free_order[page_idx] = 0;
+  list_remove (&block_at (pool, page_idx)->elem);
+}
+
+/* Returns the order of the largest block that can start at
+   PAGE_IDX without running past PAGE_CNT pages. */
+static int
+largest_order (size_t page_idx, size_t page_cnt)
+{
+  int order = 0;
+
+  while (order + 1 < BUDDY_ORDERS
+         && page_idx % ((size_t) 2 << order) == 0
+         && ((size_t) 2 << order) <= page_cnt)
+    order++;
+  return order;
+}
+
+/* Frees the block of 2**ORDER pages at PAGE_IDX into POOL,
+   merging it with its buddy for as long as the buddy is free. */
+static void
+merge_block (struct pool *pool, size_t page_idx, int order)
+{
+  while (order + 1 < BUDDY_ORDERS)
+    {
+      size_t size = (size_t) 1 << order;
+      size_t buddy = page_idx ^ size;
+
+      if (buddy + size > pool->page_cnt
+          || pool->free_order[buddy] != order + 1)
+        break;
+      remove_block (pool, buddy, order);
+      page_idx &= ~size;
+      order++;
+    }
+  insert_block (pool, page_idx, order);
+}
+
+/* Frees the PAGE_CNT pages starting at PAGE_IDX into POOL's
+   buddy free lists, as a sequence of aligned blocks. */
+static void
+buddy_free (struct pool *pool, size_t page_idx, size_t page_cnt)
+{
+  while (page_cnt > 0)
+    {
+      int order = largest_order (page_idx, page_cnt);
+      size_t size = (size_t) 1 << order;
+
+      merge_block (pool, page_idx, order);
+      page_idx += size;
+      page_cnt -= size;
+    }
+}
+
+/* Takes the PAGE_CNT free pages starting at PAGE_IDX out of
+   POOL's buddy free lists.  Each free block that overlaps the
+   range is removed, and its parts outside the range are freed
+   again. */
+static void
+buddy_claim (struct pool *pool, size_t page_idx, size_t page_cnt)
+{
+  size_t end = page_idx + page_cnt;
+
+  while (page_idx < end)
+    {
+      size_t start, block_end;
+      int order;
+
+      /* Find the free block that contains PAGE_IDX. */
+      for (order = 0; ; order++)
+        {
+          ASSERT (order < BUDDY_ORDERS);
+          start = page_idx & ~(((size_t) 1 << order) - 1);
+          if (pool->free_order[start] == order + 1)
+            break;
+        }
+      block_end = start + ((size_t) 1 << order);
+
+      remove_block (pool, start, order);
+      buddy_free (pool, start, page_idx - start);
+      if (block_end > end)
+        {
+          buddy_free (pool, end, block_end - end);
+          block_end = end;
+        }
+      page_idx = block_end;
+    }
+}
+
+/* Takes PAGE_CNT contiguous pages from POOL's buddy free lists
+   and returns the index of the first, or BITMAP_ERROR if there
+   is no free block large enough. */
+static size_t
+buddy_alloc (struct pool *pool, size_t page_cnt)
+{
+  int want = 0, order;
+  size_t page_idx;
+
+  while (((size_t) 1 << want) < page_cnt)
+    if (++want >= BUDDY_ORDERS)
+      return BITMAP_ERROR;
+
+  for (order = want; order < BUDDY_ORDERS; order++)
+    if (!list_empty (&pool->free_lists[order]))
+      break;
+  if (order >= BUDDY_ORDERS)
+    return BITMAP_ERROR;
+
+  page_idx = pg_no (list_front (&pool->free_lists[order])) - pg_no (pool->base);
+  remove_block (pool, page_idx, order);
+
+  /* Split off upper halves until the block is just big enough,
+     then give back the pages past PAGE_CNT. */
+  while (order > want)
+    {
+      order--;
+      insert_block (pool, page_idx + ((size_t) 1 << order), order);
+    }
+  buddy_free (pool, page_idx + page_cnt, ((size_t) 1 << want) - page_cnt);
+
+  return page_idx;
+}
+
+/* Calls every reclaim function and returns the total number of
+   pages freed. */
+static size_t
+reclaim (void)
+{
+  size_t freed = 0;
+  int i;
+
+  for (i = 0; i < reclaim_cnt; i++)
+    freed += reclaim_funcs[i] ();
+  return freed;
+}
+
 /* Initializes pool P as starting at START and ending at END,
    naming it NAME for debugging purposes. */
 static void
 init_pool (struct pool *p, void *base, size_t page_cnt, const char *name) 
 {
-  /* We'll put the pool's used_map at its base.
-     Calculate the space needed for the bitmap
-     and subtract it from the pool's size. */
-  size_t bm_pages = DIV_ROUND_UP (bitmap_buf_size (page_cnt), PGSIZE);
+  /* We'll put the pool's used_map at its base, followed by the
+     buddy allocator's free_order array.  Calculate the space
+     needed for them and subtract it from the pool's size. */
+  size_t bm_size = bitmap_buf_size (page_cnt);
+  size_t bm_pages = DIV_ROUND_UP (bm_size + page_cnt, PGSIZE);
+  int order;
+
   if (bm_pages > page_cnt)
     PANIC ("Not enough memory in %s for bitmap.", name);
   page_cnt -= bm_pages;
@@ -165,8 +717,17 @@ init_pool (struct pool *p, void *base, size_t page_cnt, const char *name)
 
   /* Initialize the pool. */
   lock_init (&p->lock);
-  p->used_map = bitmap_create_in_buf (page_cnt, base, bm_pages * PGSIZE);
+  p->used_map = bitmap_create_in_buf (page_cnt, base, bm_size);
   p->base = base + bm_pages * PGSIZE;
+  p->page_cnt = p->free_cnt = page_cnt;
+
+  /* Start with every page free. */
+  p->free_order = (uint8_t *) base + bm_size;
+  memset (p->free_order, 0, page_cnt);
+  for (order = 0; order < BUDDY_ORDERS; order++)
+    list_init (&p->free_lists[order]);
+  if (!palloc_bitmap)
+    buddy_free (p, 0, page_cnt);
 }
 
 /* Returns true if PAGE was allocated from POOL,
@@ -176,7 +737,7 @@ page_from_pool (const struct pool *pool, void *page)
 {
   size_t page_no = pg_no (page);
   size_t start_page = pg_no (pool->base);
-  size_t end_page = start_page + bitmap_size (pool->used_map);
+  size_t end_page = start_page + pool->page_cnt;
 
   return page_no >= start_page && page_no < end_page;
 }
@@ -1,6 +1,7 @@
 #ifndef THREADS_PALLOC_H
 #define THREADS_PALLOC_H
 
+#include <stdbool.h>
 #include <stddef.h>
 
 /* How to allocate pages. */
@@ -11,10 +12,37 @@ enum palloc_flags
     PAL_USER = 004              /* User page. */
   };
 
+/* Statistics about a pool, from palloc_get_stats(). */
+struct palloc_stats
+  {
+    size_t page_cnt;            /* Pages in the pool. */
+    size_t free_cnt;            /* Free pages. */
+    size_t largest_free;        /* Longest run of free pages. */
+    size_t zero_stock;          /* Pre-zeroed pages in stock. */
+    unsigned zero_hits;         /* PAL_ZERO pages taken from stock. */
+    unsigned zero_misses;       /* PAL_ZERO pages not in stock. */
+    unsigned zero_background;   /* Pages zeroed by the idle thread. */
+  };
+
+/* If true, allocate pages by first-fit scan of a bitmap instead
+   of with the buddy system.  Set by kernel option -palloc. */
+extern bool palloc_bitmap;
+
 void palloc_init (size_t user_page_limit);
 void *palloc_get_page (enum palloc_flags);
 void *palloc_get_multiple (enum palloc_flags, size_t page_cnt);
 void palloc_free_page (void *);
 void palloc_free_multiple (void *, size_t page_cnt);
+bool palloc_extend (void *, size_t page_cnt, size_t new_cnt);
+void palloc_get_stats (enum palloc_flags, struct palloc_stats *);
+void palloc_print_stats (void);
+bool palloc_zero_idle (void);
+
+/* Frees pages that some part of the kernel keeps cached, and
+   returns the number freed.  Called when the kernel pool runs
+   out of pages, possibly with the caller's locks held, so it
+   must not wait for a lock. */
+typedef size_t palloc_reclaim_func (void);
+void palloc_register_reclaim (palloc_reclaim_func *);
 
 #endif /* threads/palloc.h */
@@ -0,0 +1,85 @@
+#ifndef THREADS_SCHED_H
+#define THREADS_SCHED_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Scheduler classes.
+
+   Each scheduling policy is a class that owns the ready queue of
+   its threads and implements the operations below.  thread.c
+   calls them through the class of the current scheduler only, so
+   a policy pays only for its own bookkeeping, and adding one
+   means writing a new class rather than editing thread.c.
+   set_scheduler() moves the ready threads from one class to
+   another at runtime.
+
+   All operations are called with interrupts off.  Optional
+   operations may be null. */
+
+struct thread;
+
+/* # of timer ticks to give each thread. */
+#define TIME_SLICE 4
+
+struct sched_class
+  {
+    const char *name;
+
+    /* Initializes the class's ready queue.  Called once, by
+       thread_init(). */
+    void (*init) (void);
+
+    /* Called when T becomes runnable under this class: when it
+       wakes up, or when the running and ready threads move to
+       this class.  Followed by enqueue() unless T is running.
+       Optional. */
+    void (*join) (struct thread *t);
+
+    /* Adds ready thread T to the ready queue. */
+    void (*enqueue) (struct thread *t);
+
+    /* Removes ready thread T from the ready queue. */
+    void (*dequeue) (struct thread *t);
+
+    /* Removes the thread that should run next from the ready
+       queue and returns it, or returns a null pointer if the
+       ready queue is empty. */
+    struct thread *(*pick_next) (void);
+
+    /* Called on each timer tick during which CUR, which is not
+       the idle thread, was running.  Optional. */
+    void (*tick) (struct thread *cur);
+
+    /* Called by schedule() when CUR, which is not the idle
+       thread, gives up the CPU after running for RAN time-stamp
+       counter cycles.  CUR's status tells whether it yielded
+       (THREAD_READY, and already enqueued), blocked, or is
+       exiting.  Optional. */
+    void (*yield) (struct thread *cur, uint64_t ran);
+
+    /* Changes T's tickets, its weight in proportional-share
+       classes, to WEIGHT. */
+    void (*set_weight) (struct thread *t, int weight);
+
+    /* Returns the highest priority of any ready thread, or -1 if
+       there is none or the class does not order threads by
+       priority.  Used to decide on preemption. */
+    int (*max_priority) (void);
+  };
+
+extern const struct sched_class sched_rr;
+extern const struct sched_class sched_lottery;
+extern const struct sched_class sched_stride;
+
+/* Real-time threads are queued in the EDF class, which always
+   runs ahead of the current scheduler's class. */
+extern const struct sched_class sched_edf;
+bool edf_admit (struct thread *, int64_t runtime, int64_t period);
+void edf_release (struct thread *);
+bool edf_preempts (const struct thread *cur);
+
+/* Shared by thread.c and the lottery class. */
+int lottery_value (const struct thread *);
+
+#endif /* threads/sched.h */
@@ -0,0 +1,227 @@
+#include "threads/sched.h"
+#include <debug.h>
+#include <heap.h>
+#include <round.h>
+#include "devices/timer.h"
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+
+/* Earliest-deadline-first scheduler class for real-time threads,
+   with constant-bandwidth server (CBS) budgets [Abeni 1998].
+
+   A real-time thread reserves RUNTIME ticks of CPU time in every
+   PERIOD ticks.  Ready real-time threads always run before
+   best-effort threads, whatever the current scheduler, and among
+   themselves in order of absolute deadline.  Admission control
+   keeps the total reserved utilization at or below
+   EDF_UTIL_MAX, under which EDF meets every deadline.
+
+   Each thread has a budget, the CPU time it may still use before
+   its deadline, which thread_tick() charges one tick at a time.
+   When a thread uses up its budget, the CBS postpones its
+   deadline by one period and refills the budget, so that a
+   thread that overruns its reservation delays only itself, never
+   the other real-time threads.  Runtime is charged in whole
+   ticks, so a job may use up its budget without overrunning;
+   that alone is not a deadline miss.  A thread misses its
+   deadline only when it is still runnable at the deadline, and
+   is then postponed the same way. */
+
+/* Max total utilization of real-time threads, in thousandths.
+   The rest is left to best-effort threads. */
+#define EDF_UTIL_MAX 950
+
+static struct heap edf_queue;   /* Ready threads, ordered by deadline. */
+static int edf_util;            /* Reserved utilization, in thousandths. */
+
+/* Returns the utilization of a RUNTIME in PERIOD reservation, in
+   thousandths, rounded up so that admission is conservative. */
+static int
+reservation_util (int64_t runtime, int64_t period)
+{
+  return DIV_ROUND_UP (runtime * 1000, period);
+}
+
+/* Orders threads by ascending deadline, breaking ties by tid. */
+static bool
+deadline_less (const struct heap_elem *a_, const struct heap_elem *b_,
+               void *aux UNUSED)
+{
+  const struct thread *a = heap_entry (a_, struct thread, rt_elem);
+  const struct thread *b = heap_entry (b_, struct thread, rt_elem);
+
+  if (a->rt_deadline != b->rt_deadline)
+    return a->rt_deadline < b->rt_deadline;
+  return a->tid < b->tid;
+}
+
+/* Starts T's next period. */
+static void
+postpone_deadline (struct thread *t, int64_t now)
+{
+  t->rt_deadline += t->rt_period;
+  if (t->rt_deadline <= now)
+    t->rt_deadline = now + t->rt_period;
+  t->rt_budget = t->rt_runtime;
+}
+
+/* Makes T, which may already be a real-time thread, reserve
+   RUNTIME ticks in every PERIOD ticks, starting a new period now.
+   Returns false, changing nothing, if the reservation would push
+   the total utilization over EDF_UTIL_MAX.  Interrupts must be
+   off, and T must not be ready. */
+bool
+edf_admit (struct thread *t, int64_t runtime, int64_t period)
+{
+  int util = reservation_util (runtime, period);
+
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (t->status != THREAD_READY);
+  ASSERT (0 < runtime && runtime <= period);
+
+  if (t->rt_period != 0)
+    util -= reservation_util (t->rt_runtime, t->rt_period);
+  if (edf_util + util > EDF_UTIL_MAX)
+    return false;
+
+  edf_util += util;
+  t->rt_runtime = runtime;
+  t->rt_period = period;
+  t->rt_deadline = timer_ticks () + period;
+  t->rt_budget = runtime;
+  return true;
+}
+
+/* Cancels the reservation of real-time thread T, which becomes a
+   best-effort thread.  Interrupts must be off, and T must not be
+   ready. */
+void
+edf_release (struct thread *t)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (t->status != THREAD_READY);
+  ASSERT (t->rt_period != 0);
+
+  edf_util -= reservation_util (t->rt_runtime, t->rt_period);
+  t->rt_runtime = t->rt_period = 0;
+}
+
+/* Returns true if a ready real-time thread should preempt CUR:
+   if CUR is a best-effort thread, or has a later deadline. */
+bool
+edf_preempts (const struct thread *cur)
+{
+  const struct thread *t;
+
+  if (heap_empty (&edf_queue))
+    return false;
+  t = heap_entry (heap_top (&edf_queue), struct thread, rt_elem);
+  return cur->rt_period == 0 || t->rt_deadline < cur->rt_deadline;
+}
+
+static void
+edf_init (void)
+{
+  heap_init (&edf_queue, deadline_less, NULL);
+  edf_util = 0;
+}
+
+/* Applies the CBS wake-up rule to T: keeps T's deadline and
+   budget if the budget can be used up by the deadline without
+   exceeding T's reserved bandwidth, and otherwise starts a new
+   period now. */
+static void
+edf_join (struct thread *t)
+{
+  int64_t now = timer_ticks ();
+
+  if (t->rt_deadline <= now
+      || t->rt_budget * t->rt_period > (t->rt_deadline - now) * t->rt_runtime)
+    {
+      t->rt_deadline = now + t->rt_period;
+      t->rt_budget = t->rt_runtime;
+    }
+}
+
+static void
+edf_enqueue (struct thread *t)
+{
+  heap_push (&edf_queue, &t->rt_elem);
+}
+
+static void
+edf_dequeue (struct thread *t)
+{
+  heap_remove (&edf_queue, &t->rt_elem);
+}
+
+/* Removes the ready thread with the earliest deadline from the
+   ready queue and returns it.  A thread whose deadline passed
+   while it was waiting to run has missed it. */
+static struct thread *
+edf_pick_next (void)
+{
+  struct thread *t;
+  int64_t now;
+
+  if (heap_empty (&edf_queue))
+    return NULL;
+
+  t = heap_entry (heap_pop (&edf_queue), struct thread, rt_elem);
+  now = timer_ticks ();
+  if (t->rt_deadline <= now)
+    {
+      t->stats.deadline_misses++;
+      postpone_deadline (t, now);
+    }
+  return t;
+}
+
+/* Charges CUR for the tick, enforcing its budget.  Runs in the
+   timer interrupt. */
+static void
+edf_tick (struct thread *cur)
+{
+  int64_t now = timer_ticks ();
+  bool missed = cur->rt_deadline <= now;
+
+  if (--cur->rt_budget <= 0 || missed)
+    {
+      if (missed)
+        cur->stats.deadline_misses++;
+      postpone_deadline (cur, now);
+
+      /* Another real-time thread may now have an earlier
+         deadline. */
+      if (edf_preempts (cur))
+        intr_yield_on_return ();
+    }
+}
+
+/* Tickets mean nothing to EDF, but are kept so that they apply if
+   the thread becomes best-effort again. */
+static void
+edf_set_weight (struct thread *t, int weight)
+{
+  t->tickets = weight;
+}
+
+/* EDF ignores priorities.  See edf_preempts() instead. */
+static int
+edf_max_priority (void)
+{
+  return -1;
+}
+
+const struct sched_class sched_edf =
+  {
+    .name = "edf",
+    .init = edf_init,
+    .join = edf_join,
+    .enqueue = edf_enqueue,
+    .dequeue = edf_dequeue,
+    .pick_next = edf_pick_next,
+    .tick = edf_tick,
+    .set_weight = edf_set_weight,
+    .max_priority = edf_max_priority,
+  };
@@ -0,0 +1,140 @@
+#include "threads/sched.h"
+#include <debug.h>
+#include <random.h>
+#include "devices/timer.h"
+#include "threads/currency.h"
+#include "threads/lottery_rbt.h"
+#include "threads/thread.h"
+#include "threads/trace.h"
+
+/* Lottery scheduler class.
+
+   The ready queue is one ticket tree per priority, indexed by
+   priority.  Only the highest non-empty priority takes part in a
+   draw, and each draw takes O(log n) time in the number of ready
+   threads. */
+static struct ticket_node *lottery_queue[PRI_MAX + 1];
+
+/* Max compensation ticket inflation. */
+#define LOTTERY_COMP_MAX 32
+
+static int lottery_max_priority (void);
+
+/* Returns the number of base tickets that T holds in the lottery,
+   before compensation: the value of its own tickets in its
+   currency plus the tickets transferred to it by threads waiting
+   for its locks. */
+int
+lottery_value (const struct thread *t)
+{
+  return currency_thread_value (t) + t->transfer_tickets;
+}
+
+static void
+lottery_init (void)
+{
+  int i;
+
+  for (i = PRI_MIN; i <= PRI_MAX; i++)
+    lottery_queue[i] = NULL;
+}
+
+static void
+lottery_enqueue (struct thread *t)
+{
+  rbt_insert (&lottery_queue[t->priority], t,
+              lottery_value (t) + t->comp_tickets);
+}
+
+static void
+lottery_dequeue (struct thread *t)
+{
+  rbt_remove (&lottery_queue[t->priority], t);
+}
+
+/* Draws a lottery among the ready threads of the highest ready
+   priority, removes the winner from the ready queue and returns
+   it.  Winning forfeits any compensation tickets. */
+static struct thread *
+lottery_pick_next (void)
+{
+  int pri = lottery_max_priority ();
+  struct ticket_node **root;
+  struct thread *winner;
+  int total_tickets;
+
+  if (pri < 0)
+    return NULL;
+
+  root = &lottery_queue[pri];
+  total_tickets = rbt_total_tickets (*root);
+  if (total_tickets > 0)
+    winner = rbt_pick (*root, random_ulong () % total_tickets + 1);
+  else
+    winner = (*root)->t;
+  rbt_remove (root, winner);
+  winner->comp_tickets = 0;
+  TRACE (TRACE_LOTTERY, winner->tid, total_tickets);
+  return winner;
+}
+
+/* Grants compensation tickets to CUR if it is blocking after
+   running for only RAN cycles of its quantum.  A thread that used
+   only fraction F of its quantum competes with tickets / F
+   tickets until its next win, so that a thread that often blocks
+   early still receives its ticket share of the CPU [Waldspurger
+   1994].  The inflation is capped at LOTTERY_COMP_MAX times. */
+static void
+lottery_yield (struct thread *cur, uint64_t ran)
+{
+  uint64_t quantum = TIME_SLICE * timer_tsc_per_tick ();
+  int value;
+
+  if (cur->status != THREAD_BLOCKED)
+    return;
+
+  value = lottery_value (cur);
+  cur->comp_tickets = 0;
+  if (ran >= quantum)
+    return;
+  if (ran < quantum / LOTTERY_COMP_MAX)
+    ran = quantum / LOTTERY_COMP_MAX;
+  if (ran > 0)
+    cur->comp_tickets = value * quantum / ran - value;
+}
+
+static void
+lottery_set_weight (struct thread *t, int weight)
+{
+  if (t->status == THREAD_READY)
+    {
+      lottery_dequeue (t);
+      t->tickets = weight;
+      lottery_enqueue (t);
+    }
+  else
+    t->tickets = weight;
+}
+
+static int
+lottery_max_priority (void)
+{
+  int pri;
+
+  for (pri = PRI_MAX; pri >= PRI_MIN; pri--)
+    if (lottery_queue[pri] != NULL)
+      return pri;
+  return -1;
+}
+
+const struct sched_class sched_lottery =
+  {
+    .name = "lottery",
+    .init = lottery_init,
+    .enqueue = lottery_enqueue,
+    .dequeue = lottery_dequeue,
+    .pick_next = lottery_pick_next,
+    .yield = lottery_yield,
+    .set_weight = lottery_set_weight,
+    .max_priority = lottery_max_priority,
+  };
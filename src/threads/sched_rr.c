@@ -0,0 +1,90 @@
+#include "threads/sched.h"
+#include <debug.h>
+#include <list.h>
+#include "threads/thread.h"
+
+/* Round-robin scheduler class, with strict priorities.  Also
+   used by the multi-level feedback queue scheduler, which only
+   differs in how it computes priorities.
+
+   There is one FIFO list of ready threads per priority, plus a
+   bitmap with bit P set when prio_queue[P] is non-empty, so that
+   the highest ready priority is found with a single bit scan. */
+static struct list prio_queue[PRI_MAX + 1];
+static uint64_t prio_bitmap;
+
+static int rr_max_priority (void);
+
+static void
+rr_init (void)
+{
+  int i;
+
+  for (i = PRI_MIN; i <= PRI_MAX; i++)
+    list_init (&prio_queue[i]);
+  prio_bitmap = 0;
+}
+
+static void
+rr_enqueue (struct thread *t)
+{
+  list_push_back (&prio_queue[t->priority], &t->elem);
+  prio_bitmap |= (uint64_t) 1 << t->priority;
+}
+
+static void
+rr_dequeue (struct thread *t)
+{
+  list_remove (&t->elem);
+  if (list_empty (&prio_queue[t->priority]))
+    prio_bitmap &= ~((uint64_t) 1 << t->priority);
+}
+
+/* Removes and returns the first thread of the highest non-empty
+   priority. */
+static struct thread *
+rr_pick_next (void)
+{
+  int pri = rr_max_priority ();
+  struct thread *t;
+
+  if (pri < 0)
+    return NULL;
+
+  t = list_entry (list_front (&prio_queue[pri]), struct thread, elem);
+  rr_dequeue (t);
+  return t;
+}
+
+/* Tickets mean nothing to round-robin, but are kept so that they
+   apply if the scheduler changes. */
+static void
+rr_set_weight (struct thread *t, int weight)
+{
+  t->tickets = weight;
+}
+
+static int
+rr_max_priority (void)
+{
+  uint32_t high = prio_bitmap >> 32;
+  uint32_t low = prio_bitmap;
+
+  if (high != 0)
+    return 63 - __builtin_clz (high);
+  else if (low != 0)
+    return 31 - __builtin_clz (low);
+  else
+    return -1;
+}
+
+const struct sched_class sched_rr =
+  {
+    .name = "rr",
+    .init = rr_init,
+    .enqueue = rr_enqueue,
+    .dequeue = rr_dequeue,
+    .pick_next = rr_pick_next,
+    .set_weight = rr_set_weight,
+    .max_priority = rr_max_priority,
+  };
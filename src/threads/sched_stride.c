@@ -0,0 +1,134 @@
+#include "threads/sched.h"
+#include <debug.h>
+#include <heap.h>
+#include "threads/thread.h"
+
+/* Stride scheduler class.
+
+   Each thread advances its pass by its stride, STRIDE_ONE /
+   tickets, every time it is dispatched, and the ready thread with
+   the lowest pass runs next.  The global pass advances by
+   STRIDE_ONE / (total runnable tickets) per dispatch; a thread
+   that blocks remembers how far it was from the global pass and
+   rejoins at the same distance when it wakes up.  A new thread
+   starts at the global pass. */
+#define STRIDE_ONE (1 << 20)
+static struct heap stride_queue;  /* Ready threads, ordered by pass. */
+static int stride_tickets;        /* Total tickets in stride_queue. */
+static int64_t global_pass;       /* Pass of the system as a whole. */
+
+/* Orders threads by ascending pass, breaking ties by tid so that
+   the schedule is deterministic. */
+static bool
+pass_less (const struct heap_elem *a_, const struct heap_elem *b_,
+           void *aux UNUSED)
+{
+  const struct thread *a = heap_entry (a_, struct thread, stride_elem);
+  const struct thread *b = heap_entry (b_, struct thread, stride_elem);
+
+  if (a->pass != b->pass)
+    return a->pass < b->pass;
+  return a->tid < b->tid;
+}
+
+/* Returns T's stride, the amount its pass advances per quantum. */
+static int
+thread_stride (const struct thread *t)
+{
+  return STRIDE_ONE / t->tickets;
+}
+
+static void
+stride_init (void)
+{
+  heap_init (&stride_queue, pass_less, NULL);
+  stride_tickets = 0;
+}
+
+/* Places T's pass at the distance from the global pass that it
+   had when it last blocked. */
+static void
+stride_join (struct thread *t)
+{
+  t->pass = global_pass + t->pass_remain;
+}
+
+static void
+stride_enqueue (struct thread *t)
+{
+  heap_push (&stride_queue, &t->stride_elem);
+  stride_tickets += t->tickets;
+}
+
+static void
+stride_dequeue (struct thread *t)
+{
+  heap_remove (&stride_queue, &t->stride_elem);
+  stride_tickets -= t->tickets;
+}
+
+/* Removes the ready thread with the lowest pass from the ready
+   queue, charges it for one quantum, advances the global pass
+   accordingly, and returns it. */
+static struct thread *
+stride_pick_next (void)
+{
+  struct thread *t;
+
+  if (heap_empty (&stride_queue))
+    return NULL;
+
+  t = heap_entry (heap_pop (&stride_queue), struct thread, stride_elem);
+
+  /* The thread about to run counts as runnable too. */
+  global_pass += STRIDE_ONE / stride_tickets;
+  stride_tickets -= t->tickets;
+  t->pass += thread_stride (t);
+  return t;
+}
+
+/* When CUR stops being runnable, remembers how far its pass is
+   from the global pass, so that blocking neither gains nor loses
+   it any share. */
+static void
+stride_yield (struct thread *cur, uint64_t ran UNUSED)
+{
+  if (cur->status != THREAD_READY)
+    cur->pass_remain = cur->pass - global_pass;
+}
+
+/* Changes T's tickets to WEIGHT, scaling the distance of its
+   pass from the global pass by the change in its stride. */
+static void
+stride_set_weight (struct thread *t, int weight)
+{
+  bool ready = t->status == THREAD_READY;
+
+  if (ready)
+    stride_dequeue (t);
+  t->pass = global_pass + (t->pass - global_pass) * t->tickets / weight;
+  t->pass_remain = t->pass_remain * t->tickets / weight;
+  t->tickets = weight;
+  if (ready)
+    stride_enqueue (t);
+}
+
+/* Stride scheduling ignores priorities. */
+static int
+stride_max_priority (void)
+{
+  return -1;
+}
+
+const struct sched_class sched_stride =
+  {
+    .name = "stride",
+    .init = stride_init,
+    .join = stride_join,
+    .enqueue = stride_enqueue,
+    .dequeue = stride_dequeue,
+    .pick_next = stride_pick_next,
+    .yield = stride_yield,
+    .set_weight = stride_set_weight,
+    .max_priority = stride_max_priority,
+  };
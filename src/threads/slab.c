@@ -0,0 +1,351 @@
+#include "threads/slab.h"
+#include <debug.h>
+#include <round.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/vaddr.h"
+
+/* Slab allocator, after Bonwick, "The Slab Allocator: An
+   Object-Caching Kernel Memory Allocator" (USENIX 1994).
+
+   A slab cache hands out objects of a single size, for kernel
+   structures that are allocated and freed often.  Unlike
+   malloc(), which rounds every request up to its next size
+   class, the cache packs objects at their own size, so that, for
+   example, seven 536-byte inodes fit in a page instead of the
+   six 640-byte blocks of malloc().  It also keeps constructed
+   objects and colors its slabs, as described below.
+
+   Each slab is one page: a header, an array of free-list links,
+   and then the objects.  The free list of a slab is kept in the
+   link array rather than in the free objects themselves, so that
+   objects keep the state the optional constructor gave them
+   while they are free, and the constructor runs only once per
+   object, when its slab is created.
+
+   A cache keeps its slabs on three lists: partial slabs, from
+   which objects are allocated first, full slabs, and empty
+   slabs.  At most one empty slab is kept when objects are freed;
+   slab_shrink() returns it to the page allocator too, and the
+   page allocator calls slab_shrink() on every cache when it runs
+   out of kernel pages.
+
+   Page-sized slabs leave some bytes unused at the end.  The
+   cache uses them to "color" its slabs: each new slab starts its
+   objects a different multiple of the alignment further into
+   the page, so that objects at the same index in different slabs
+   do not all compete for the same cache lines. */
+
+/* Magic number for detecting slab corruption. */
+#define SLAB_MAGIC 0x51ab51ab
+
+/* Marks the end of a slab's free list. */
+#define SLAB_END UINT16_MAX
+
+/* Most empty slabs a cache keeps while objects are freed. */
+#define SLAB_EMPTY_MAX 1
+
+/* A slab, stored at the start of its page. */
+struct slab
+  {
+    unsigned magic;             /* Always set to SLAB_MAGIC. */
+    struct slab_cache *cache;   /* Owning cache. */
+    struct list_elem elem;      /* Element in one of the cache's lists. */
+    uint8_t *objs;              /* First object. */
+    size_t inuse_cnt;           /* Objects allocated. */
+    uint16_t free;              /* Index of first free object. */
+    uint16_t next[];            /* Next free object after each one. */
+  };
+
+/* All slab caches.  Caches are never destroyed. */
+static struct list all_caches;
+
+static size_t reclaim_caches (void);
+
+/* Initializes the slab allocator. */
+void
+slab_init (void) 
+{
+  list_init (&all_caches);
+  palloc_register_reclaim (reclaim_caches);
+}
+
+/* Returns the number of objects of SIZE bytes, aligned on ALIGN
+   bytes, that fit in a slab. */
+static size_t
+objs_per_slab (size_t size, size_t align) 
+{
+  size_t n = (PGSIZE - sizeof (struct slab)) / size;
+
+  while (n > 0
+         && (ROUND_UP (sizeof (struct slab) + n * sizeof (uint16_t), align)
+             + n * size) > PGSIZE)
+    n--;
+  return n;
+}
+
+/* Initializes CACHE as a cache of objects of SIZE bytes, aligned
+   on ALIGN bytes, which must be a power of 2, or on the size of a
+   pointer if ALIGN is 0.  If CTOR is nonnull, it is called with
+   each object and AUX when the object's slab is created. */
+void
+slab_cache_init (struct slab_cache *cache, const char *name, size_t size,
+                 size_t align, slab_ctor_func *ctor, void *aux) 
+{
+  enum intr_level old_level;
+  size_t slack;
+
+  ASSERT (cache != NULL);
+  ASSERT (size > 0);
+  ASSERT ((align & (align - 1)) == 0);
+
+  if (align < sizeof (void *))
+    align = sizeof (void *);
+
+  cache->name = name;
+  cache->obj_size = ROUND_UP (size, align);
+  cache->align = align;
+  cache->objs_per_slab = objs_per_slab (cache->obj_size, align);
+  ASSERT (cache->objs_per_slab > 0 && cache->objs_per_slab < SLAB_END);
+  cache->first_ofs = ROUND_UP (sizeof (struct slab)
+                               + cache->objs_per_slab * sizeof (uint16_t),
+                               align);
+  slack = PGSIZE - cache->first_ofs - cache->objs_per_slab * cache->obj_size;
+  cache->color_cnt = slack / align + 1;
+  cache->next_color = 0;
+  cache->ctor = ctor;
+  cache->aux = aux;
+
+  lock_init (&cache->lock);
+  list_init (&cache->partial);
+  list_init (&cache->full);
+  list_init (&cache->empty);
+  cache->slab_cnt = 0;
+  cache->inuse_cnt = 0;
+  cache->peak_cnt = 0;
+
+  old_level = intr_disable ();
+  list_push_back (&all_caches, &cache->elem);
+  intr_set_level (old_level);
+}
+
+/* Creates a new, empty slab for CACHE and returns it, or returns
+   a null pointer if no page is available.  CACHE's lock must be
+   held. */
+static struct slab *
+slab_create (struct slab_cache *cache) 
+{
+  struct slab *s = palloc_get_page (0);
+  size_t i;
+
+  if (s == NULL)
+    return NULL;
+
+  s->magic = SLAB_MAGIC;
+  s->cache = cache;
+  s->objs = (uint8_t *) s + cache->first_ofs + cache->next_color * cache->align;
+  s->inuse_cnt = 0;
+  s->free = 0;
+  for (i = 0; i < cache->objs_per_slab; i++)
+    {
+      s->next[i] = i + 1 < cache->objs_per_slab ? i + 1 : SLAB_END;
+      if (cache->ctor != NULL)
+        cache->ctor (s->objs + i * cache->obj_size, cache->aux);
+    }
+
+  if (++cache->next_color >= cache->color_cnt)
+    cache->next_color = 0;
+  cache->slab_cnt++;
+  return s;
+}
+
+/* Returns the slab that contains OBJ, which must belong to
+   CACHE. */
+static struct slab *
+obj_to_slab (struct slab_cache *cache, void *obj) 
+{
+  struct slab *s = pg_round_down (obj);
+
+  ASSERT (s->magic == SLAB_MAGIC);
+  ASSERT (s->cache == cache);
+  ASSERT ((uint8_t *) obj >= s->objs);
+  ASSERT (((uint8_t *) obj - s->objs) % cache->obj_size == 0);
+  return s;
+}
+
+/* Allocates and returns an object from CACHE, or returns a null
+   pointer if memory is not available.  The object is not zeroed;
+   it is in the state the cache's constructor, if any, left it
+   in, or in which it was last freed. */
+void *
+slab_alloc (struct slab_cache *cache) 
+{
+  struct slab *s;
+  void *obj;
+
+  ASSERT (cache != NULL);
+
+  lock_acquire (&cache->lock);
+  if (!list_empty (&cache->partial))
+    s = list_entry (list_front (&cache->partial), struct slab, elem);
+  else if (!list_empty (&cache->empty))
+    {
+      s = list_entry (list_pop_front (&cache->empty), struct slab, elem);
+      list_push_front (&cache->partial, &s->elem);
+    }
+  else
+    {
+      s = slab_create (cache);
+      if (s == NULL)
+        {
+          lock_release (&cache->lock);
+          return NULL;
+        }
+      list_push_front (&cache->partial, &s->elem);
+    }
+
+  ASSERT (s->free != SLAB_END);
+  obj = s->objs + s->free * cache->obj_size;
+  s->free = s->next[s->free];
+  if (++s->inuse_cnt == cache->objs_per_slab)
+    {
+      list_remove (&s->elem);
+      list_push_front (&cache->full, &s->elem);
+    }
+  if (++cache->inuse_cnt > cache->peak_cnt)
+    cache->peak_cnt = cache->inuse_cnt;
+  lock_release (&cache->lock);
+
+  return obj;
+}
+
+/* Returns OBJ, which must have been allocated from CACHE, to
+   CACHE.  If it has a constructor, OBJ must be back in its
+   constructed state. */
+void
+slab_free (struct slab_cache *cache, void *obj) 
+{
+  struct slab *s;
+  size_t idx;
+
+  if (obj == NULL)
+    return;
+
+  s = obj_to_slab (cache, obj);
+  idx = ((uint8_t *) obj - s->objs) / cache->obj_size;
+
+#ifndef NDEBUG
+  /* Clear the object to help detect use-after-free bugs, unless
+     its constructed state must be kept. */
+  if (cache->ctor == NULL)
+    memset (obj, 0xcc, cache->obj_size);
+#endif
+
+  lock_acquire (&cache->lock);
+  ASSERT (s->inuse_cnt > 0);
+  s->next[idx] = s->free;
+  s->free = idx;
+  cache->inuse_cnt--;
+  if (s->inuse_cnt-- == cache->objs_per_slab)
+    {
+      list_remove (&s->elem);
+      list_push_front (&cache->partial, &s->elem);
+    }
+  if (s->inuse_cnt == 0)
+    {
+      list_remove (&s->elem);
+      if (list_size (&cache->empty) < SLAB_EMPTY_MAX)
+        list_push_front (&cache->empty, &s->elem);
+      else
+        {
+          cache->slab_cnt--;
+          palloc_free_page (s);
+        }
+    }
+  lock_release (&cache->lock);
+}
+
+/* Returns CACHE's empty slabs to the page allocator, and returns
+   the number of pages freed.  CACHE's lock must be held. */
+static size_t
+shrink_locked (struct slab_cache *cache) 
+{
+  size_t freed = 0;
+
+  while (!list_empty (&cache->empty))
+    {
+      struct slab *s = list_entry (list_pop_front (&cache->empty),
+                                   struct slab, elem);
+      palloc_free_page (s);
+      freed++;
+    }
+  cache->slab_cnt -= freed;
+  return freed;
+}
+
+/* Returns CACHE's empty slabs to the page allocator, and returns
+   the number of pages freed. */
+size_t
+slab_shrink (struct slab_cache *cache) 
+{
+  size_t freed;
+
+  ASSERT (cache != NULL);
+
+  lock_acquire (&cache->lock);
+  freed = shrink_locked (cache);
+  lock_release (&cache->lock);
+
+  return freed;
+}
+
+/* Shrinks every cache whose lock is free.  Called by the page
+   allocator when it runs out of kernel pages, possibly from
+   slab_create() with a cache's lock held, so it must not wait
+   for a cache lock. */
+static size_t
+reclaim_caches (void) 
+{
+  size_t freed = 0;
+  struct list_elem *e;
+
+  for (e = list_begin (&all_caches); e != list_end (&all_caches);
+       e = list_next (e))
+    {
+      struct slab_cache *c = list_entry (e, struct slab_cache, elem);
+
+      if (!lock_held_by_current_thread (&c->lock)
+          && lock_try_acquire (&c->lock))
+        {
+          freed += shrink_locked (c);
+          lock_release (&c->lock);
+        }
+    }
+  return freed;
+}
+
+/* Prints statistics for every cache, including how much memory
+   its objects would take from malloc() at their peak. */
+void
+slab_print_stats (void) 
+{
+  struct list_elem *e;
+
+  for (e = list_begin (&all_caches); e != list_end (&all_caches);
+       e = list_next (e))
+    {
+      struct slab_cache *c = list_entry (e, struct slab_cache, elem);
+
+      printf ("Slab cache %s: %zu-byte objects, %zu per slab, "
+              "%zu in use, %zu at peak, %zu slabs; "
+              "%zu bytes at peak, %zu with malloc\n",
+              c->name, c->obj_size, c->objs_per_slab, c->inuse_cnt,
+              c->peak_cnt, c->slab_cnt,
+              DIV_ROUND_UP (c->peak_cnt, c->objs_per_slab) * PGSIZE,
+              c->peak_cnt * malloc_block_size (c->obj_size));
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef THREADS_SLAB_H
+#define THREADS_SLAB_H
+
+#include <list.h>
+#include <stddef.h>
+#include "threads/synch.h"
+
+/* Initializes object OBJ, when its slab is created.  Objects
+   must be returned to their cache in their constructed state. */
+typedef void slab_ctor_func (void *obj, void *aux);
+
+/* A cache of fixed-size objects.  Fields are private to
+   slab.c. */
+struct slab_cache
+  {
+    const char *name;           /* Name, for statistics. */
+    size_t obj_size;            /* Object size, a multiple of align. */
+    size_t align;               /* Object alignment. */
+    size_t objs_per_slab;       /* Objects in each slab. */
+    size_t first_ofs;           /* Offset of the first object. */
+    size_t color_cnt;           /* Number of distinct colors. */
+    size_t next_color;          /* Color of the next slab. */
+    slab_ctor_func *ctor;       /* Constructor, or null. */
+    void *aux;                  /* Constructor's auxiliary data. */
+
+    struct lock lock;           /* Protects the members below. */
+    struct list partial;        /* Slabs with some objects free. */
+    struct list full;           /* Slabs with no objects free. */
+    struct list empty;          /* Slabs with all objects free. */
+    size_t slab_cnt;            /* Slabs in all three lists. */
+    size_t inuse_cnt;           /* Objects allocated. */
+    size_t peak_cnt;            /* Most objects allocated at once. */
+
+    struct list_elem elem;      /* Element in list of all caches. */
+  };
+
+void slab_init (void);
+void slab_cache_init (struct slab_cache *, const char *name, size_t size,
+                      size_t align, slab_ctor_func *, void *aux);
+void *slab_alloc (struct slab_cache *);
+void slab_free (struct slab_cache *, void *);
+size_t slab_shrink (struct slab_cache *);
+void slab_print_stats (void);
+
+#endif /* threads/slab.h */
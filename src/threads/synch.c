@@ -30,8 +30,101 @@
 #include <stdio.h>
 #include <string.h>
 #include "threads/interrupt.h"
+#include "threads/sched.h"
 #include "threads/thread.h"
 
+/* Wait queues.
+
+   The threads waiting on a semaphore or condition variable are
+   kept in a heap, so that the one to wake next is found in O(1)
+   time and removed in O(log n).  A waiter is woken before another
+   if it has a higher effective priority, or, at equal priority,
+   more lottery tickets, or, at equal tickets, if it has waited
+   longer.  Priorities are current: when a waiting thread's
+   priority or tickets change, thread.c calls
+   synch_waiter_changed() to move it to its new place.  The heaps
+   are accessed with interrupts off. */
+
+/* Sequence number of the next waiter to be queued. */
+static unsigned next_wait_seq;
+
+/* One semaphore in a list. */
+struct semaphore_elem 
+  {
+    struct heap_elem elem;              /* Condition wait queue element. */
+    struct semaphore semaphore;         /* This semaphore. */
+    struct thread *thread;              /* Thread waiting on it. */
+    struct condition *cond;             /* Condition waited for. */
+    int tickets;                        /* Thread's tickets when queued. */
+    unsigned seq;                       /* Order in which queued. */
+  };
+
+/* Returns true if a waiter with priority PA, TA tickets and
+   sequence number SA should be woken before one with priority PB,
+   TB tickets and sequence number SB. */
+static bool
+wakes_before (int pa, int ta, unsigned sa, int pb, int tb, unsigned sb)
+{
+  if (pa != pb)
+    return pa > pb;
+  if (ta != tb)
+    return ta > tb;
+  return (int) (sa - sb) < 0;
+}
+
+/* Orders threads waiting on a semaphore. */
+static bool
+sema_waiter_less (const struct heap_elem *a_, const struct heap_elem *b_,
+                  void *aux UNUSED)
+{
+  const struct thread *a = heap_entry (a_, struct thread, wait_elem);
+  const struct thread *b = heap_entry (b_, struct thread, wait_elem);
+
+  return wakes_before (a->priority, a->wait_tickets, a->wait_seq,
+                       b->priority, b->wait_tickets, b->wait_seq);
+}
+
+/* Orders threads waiting on a condition variable. */
+static bool
+cond_waiter_less (const struct heap_elem *a_, const struct heap_elem *b_,
+                  void *aux UNUSED)
+{
+  const struct semaphore_elem *a = heap_entry (a_, struct semaphore_elem,
+                                               elem);
+  const struct semaphore_elem *b = heap_entry (b_, struct semaphore_elem,
+                                               elem);
+
+  return wakes_before (a->thread->priority, a->tickets, a->seq,
+                       b->thread->priority, b->tickets, b->seq);
+}
+
+/* Moves T, whose priority or tickets have just changed, to its
+   new place in the wait queues it is in, if any.  Interrupts must
+   be off. */
+void
+synch_waiter_changed (struct thread *t)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (t->waiting_sema != NULL)
+    {
+      struct heap *waiters = &t->waiting_sema->waiters;
+
+      heap_remove (waiters, &t->wait_elem);
+      t->wait_tickets = lottery_value (t);
+      heap_push (waiters, &t->wait_elem);
+    }
+  if (t->waiting_cond != NULL)
+    {
+      struct semaphore_elem *w = t->waiting_cond;
+      struct heap *waiters = &w->cond->waiters;
+
+      heap_remove (waiters, &w->elem);
+      w->tickets = lottery_value (t);
+      heap_push (waiters, &w->elem);
+    }
+}
+
 /* Initializes semaphore SEMA to VALUE.  A semaphore is a
    nonnegative integer along with two atomic operators for
    manipulating it:
@@ -47,7 +140,7 @@ sema_init (struct semaphore *sema, unsigned value)
   ASSERT (sema != NULL);
 
   sema->value = value;
-  list_init (&sema->waiters);
+  heap_init (&sema->waiters, sema_waiter_less, NULL);
 }
 
 /* Down or "P" operation on a semaphore.  Waits for SEMA's value
@@ -68,7 +161,12 @@ sema_down (struct semaphore *sema)
   old_level = intr_disable ();
   while (sema->value == 0) 
     {
-      list_push_back (&sema->waiters, &thread_current ()->elem);
+      struct thread *cur = thread_current ();
+
+      cur->waiting_sema = sema;
+      cur->wait_tickets = lottery_value (cur);
+      cur->wait_seq = next_wait_seq++;
+      heap_push (&sema->waiters, &cur->wait_elem);
       thread_block ();
     }
   sema->value--;
@@ -102,22 +200,36 @@ sema_try_down (struct semaphore *sema)
 }
 
 /* Up or "V" operation on a semaphore.  Increments SEMA's value
-   and wakes up one thread of those waiting for SEMA, if any.
+   and wakes up the first of the threads waiting for SEMA, if any
+   (see "Wait queues" above).  If that thread should preempt the
+   running thread, yields the CPU to it, or, in an interrupt
+   handler, as soon as the handler returns.  A caller that has
+   turned interrupts off is not rescheduled; the woken thread
+   waits until the caller yields or its time slice ends.
 
    This function may be called from an interrupt handler. */
 void
 sema_up (struct semaphore *sema) 
 {
   enum intr_level old_level;
+  bool woke = false;
 
   ASSERT (sema != NULL);
 
   old_level = intr_disable ();
-  if (!list_empty (&sema->waiters)) 
-    thread_unblock (list_entry (list_pop_front (&sema->waiters),
-                                struct thread, elem));
+  if (!heap_empty (&sema->waiters)) 
+    {
+      struct thread *t = heap_entry (heap_pop (&sema->waiters),
+                                     struct thread, wait_elem);
+      t->waiting_sema = NULL;
+      thread_unblock (t);
+      woke = true;
+    }
   sema->value++;
   intr_set_level (old_level);
+
+  if (woke && (old_level == INTR_ON || intr_context ()))
+    thread_preempt ();
 }
 
 static void sema_test_helper (void *sema_);
@@ -185,6 +297,10 @@ lock_init (struct lock *lock)
    necessary.  The lock must not already be held by the current
    thread.
 
+   While the current thread waits, it donates its priority to the
+   lock's holder, and through it to any thread that the holder is
+   itself waiting for (see thread_donate_priority()).
+
    This function may sleep, so it must not be called within an
    interrupt handler.  This function may be called with
    interrupts disabled, but interrupts will be turned back on if
@@ -192,12 +308,28 @@ lock_init (struct lock *lock)
 void
 lock_acquire (struct lock *lock)
 {
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+
   ASSERT (lock != NULL);
   ASSERT (!intr_context ());
   ASSERT (!lock_held_by_current_thread (lock));
 
+  old_level = intr_disable ();
+  if (lock->holder != NULL)
+    {
+      cur->waiting_lock = lock;
+      thread_donate_priority (cur);
+      thread_transfer_tickets (cur);
+    }
   sema_down (&lock->semaphore);
-  lock->holder = thread_current ();
+  cur->waiting_lock = NULL;
+  lock->holder = cur;
+  list_push_back (&cur->held_locks, &lock->elem);
+
+  /* Any remaining waiters now fund the new holder. */
+  thread_refresh_tickets (cur);
+  intr_set_level (old_level);
 }
 
 /* Tries to acquires LOCK and returns true if successful or false
@@ -216,11 +348,17 @@ lock_try_acquire (struct lock *lock)
 
   success = sema_try_down (&lock->semaphore);
   if (success)
-    lock->holder = thread_current ();
+    {
+      enum intr_level old_level = intr_disable ();
+      lock->holder = thread_current ();
+      list_push_back (&lock->holder->held_locks, &lock->elem);
+      intr_set_level (old_level);
+    }
   return success;
 }
 
 /* Releases LOCK, which must be owned by the current thread.
+   Any priority donated through LOCK is given up.
 
    An interrupt handler cannot acquire a lock, so it does not
    make sense to try to release a lock within an interrupt
@@ -228,10 +366,18 @@ lock_try_acquire (struct lock *lock)
 void
 lock_release (struct lock *lock) 
 {
+  enum intr_level old_level;
+
   ASSERT (lock != NULL);
   ASSERT (lock_held_by_current_thread (lock));
 
+  old_level = intr_disable ();
+  list_remove (&lock->elem);
   lock->holder = NULL;
+  thread_refresh_priority (thread_current ());
+  thread_refresh_tickets (thread_current ());
+  intr_set_level (old_level);
+
   sema_up (&lock->semaphore);
 }
 
@@ -246,13 +392,6 @@ lock_held_by_current_thread (const struct lock *lock)
   return lock->holder == thread_current ();
 }
 
-/* One semaphore in a list. */
-struct semaphore_elem 
-  {
-    struct list_elem elem;              /* List element. */
-    struct semaphore semaphore;         /* This semaphore. */
-  };
-
 /* Initializes condition variable COND.  A condition variable
    allows one piece of code to signal a condition and cooperating
    code to receive the signal and act upon it. */
@@ -261,7 +400,7 @@ cond_init (struct condition *cond)
 {
   ASSERT (cond != NULL);
 
-  list_init (&cond->waiters);
+  heap_init (&cond->waiters, cond_waiter_less, NULL);
 }
 
 /* Atomically releases LOCK and waits for COND to be signaled by
@@ -288,6 +427,7 @@ void
 cond_wait (struct condition *cond, struct lock *lock) 
 {
   struct semaphore_elem waiter;
+  enum intr_level old_level;
 
   ASSERT (cond != NULL);
   ASSERT (lock != NULL);
@@ -295,15 +435,25 @@ cond_wait (struct condition *cond, struct lock *lock)
   ASSERT (lock_held_by_current_thread (lock));
   
   sema_init (&waiter.semaphore, 0);
-  list_push_back (&cond->waiters, &waiter.elem);
+  waiter.thread = thread_current ();
+  waiter.cond = cond;
+
+  old_level = intr_disable ();
+  waiter.tickets = lottery_value (waiter.thread);
+  waiter.seq = next_wait_seq++;
+  heap_push (&cond->waiters, &waiter.elem);
+  waiter.thread->waiting_cond = &waiter;
+  intr_set_level (old_level);
+
   lock_release (lock);
   sema_down (&waiter.semaphore);
   lock_acquire (lock);
 }
 
 /* If any threads are waiting on COND (protected by LOCK), then
-   this function signals one of them to wake up from its wait.
-   LOCK must be held before calling this function.
+   this function signals the first of them (see "Wait queues"
+   above) to wake up from its wait.  LOCK must be held before
+   calling this function.
 
    An interrupt handler cannot acquire a lock, so it does not
    make sense to try to signal a condition variable within an
@@ -311,14 +461,24 @@ cond_wait (struct condition *cond, struct lock *lock)
 void
 cond_signal (struct condition *cond, struct lock *lock UNUSED) 
 {
+  struct semaphore_elem *w = NULL;
+  enum intr_level old_level;
+
   ASSERT (cond != NULL);
   ASSERT (lock != NULL);
   ASSERT (!intr_context ());
   ASSERT (lock_held_by_current_thread (lock));
 
-  if (!list_empty (&cond->waiters)) 
-    sema_up (&list_entry (list_pop_front (&cond->waiters),
-                          struct semaphore_elem, elem)->semaphore);
+  old_level = intr_disable ();
+  if (!heap_empty (&cond->waiters)) 
+    {
+      w = heap_entry (heap_pop (&cond->waiters), struct semaphore_elem, elem);
+      w->thread->waiting_cond = NULL;
+    }
+  intr_set_level (old_level);
+
+  if (w != NULL)
+    sema_up (&w->semaphore);
 }
 
 /* Wakes up all threads, if any, waiting on COND (protected by
@@ -333,6 +493,306 @@ cond_broadcast (struct condition *cond, struct lock *lock)
   ASSERT (cond != NULL);
   ASSERT (lock != NULL);
 
-  while (!list_empty (&cond->waiters))
+  while (!heap_empty (&cond->waiters))
     cond_signal (cond, lock);
 }
+
+/* Initializes RWLOCK as a reader-writer lock that favors writers
+   or readers according to POLICY.  Any number of threads may
+   hold a reader-writer lock for reading at once, or else a
+   single thread may hold it for writing.
+
+   With RWLOCK_PREFER_WRITERS, a new reader waits while any
+   writer waits, so that a stream of readers cannot starve
+   writers; a thread that already holds the lock for reading must
+   therefore not acquire it for reading again.  With
+   RWLOCK_PREFER_READERS, readers enter whenever no writer holds
+   the lock, which gives the most read concurrency but may starve
+   writers.
+
+   Unlike a lock, a reader-writer lock does not donate priority
+   to the threads holding it, except while waiting for its
+   internal lock. */
+void
+rwlock_init (struct rwlock *rw, enum rwlock_policy policy)
+{
+  ASSERT (rw != NULL);
+
+  lock_init (&rw->lock);
+  cond_init (&rw->read_ok);
+  cond_init (&rw->write_ok);
+  cond_init (&rw->upgrade_ok);
+  rw->writer = NULL;
+  rw->readers = 0;
+  rw->waiting_readers = 0;
+  rw->waiting_writers = 0;
+  rw->upgrading = false;
+  rw->policy = policy;
+}
+
+/* Returns true if a reader may enter RW now.  RW's lock must be
+   held. */
+static bool
+rwlock_can_read (const struct rwlock *rw)
+{
+  return (rw->writer == NULL && !rw->upgrading
+          && (rw->policy != RWLOCK_PREFER_WRITERS
+              || rw->waiting_writers == 0));
+}
+
+/* Returns true if a writer may enter RW now.  RW's lock must be
+   held. */
+static bool
+rwlock_can_write (const struct rwlock *rw)
+{
+  return (rw->writer == NULL && rw->readers == 0 && !rw->upgrading
+          && (rw->policy != RWLOCK_PREFER_READERS
+              || rw->waiting_readers == 0));
+}
+
+/* Wakes up the threads that may enter RW now that it has become
+   free.  RW's lock must be held. */
+static void
+rwlock_wake (struct rwlock *rw)
+{
+  if (rw->waiting_writers > 0
+      && (rw->policy == RWLOCK_PREFER_WRITERS || rw->waiting_readers == 0))
+    cond_signal (&rw->write_ok, &rw->lock);
+  else if (rw->waiting_readers > 0)
+    cond_broadcast (&rw->read_ok, &rw->lock);
+}
+
+/* Acquires RW for reading, sleeping until no writer holds it and,
+   with RWLOCK_PREFER_WRITERS, none waits for it.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+void
+rwlock_acquire_read (struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+  ASSERT (rw->writer != thread_current ());
+
+  lock_acquire (&rw->lock);
+  rw->waiting_readers++;
+  while (!rwlock_can_read (rw))
+    cond_wait (&rw->read_ok, &rw->lock);
+  rw->waiting_readers--;
+  rw->readers++;
+  lock_release (&rw->lock);
+}
+
+/* Tries to acquire RW for reading without sleeping and returns
+   true if successful or false on failure.  Also fails, rather
+   than waiting, if another thread is inside one of the rwlock
+   functions on RW. */
+bool
+rwlock_try_acquire_read (struct rwlock *rw)
+{
+  bool success;
+
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+
+  if (!lock_try_acquire (&rw->lock))
+    return false;
+  success = rwlock_can_read (rw);
+  if (success)
+    rw->readers++;
+  lock_release (&rw->lock);
+  return success;
+}
+
+/* Releases RW, which the current thread must hold for reading. */
+void
+rwlock_release_read (struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+
+  lock_acquire (&rw->lock);
+  ASSERT (rw->readers > 0);
+  rw->readers--;
+  if (rw->upgrading)
+    {
+      /* The only reader left is the one upgrading. */
+      if (rw->readers == 1)
+        cond_signal (&rw->upgrade_ok, &rw->lock);
+    }
+  else if (rw->readers == 0)
+    rwlock_wake (rw);
+  lock_release (&rw->lock);
+}
+
+/* Acquires RW for writing, sleeping until no other thread holds
+   it and, with RWLOCK_PREFER_READERS, no reader waits for it.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+void
+rwlock_acquire_write (struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+  ASSERT (rw->writer != thread_current ());
+
+  lock_acquire (&rw->lock);
+  rw->waiting_writers++;
+  while (!rwlock_can_write (rw))
+    cond_wait (&rw->write_ok, &rw->lock);
+  rw->waiting_writers--;
+  rw->writer = thread_current ();
+  lock_release (&rw->lock);
+}
+
+/* Tries to acquire RW for writing without sleeping and returns
+   true if successful or false on failure.  Also fails, rather
+   than waiting, if another thread is inside one of the rwlock
+   functions on RW. */
+bool
+rwlock_try_acquire_write (struct rwlock *rw)
+{
+  bool success;
+
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+  ASSERT (rw->writer != thread_current ());
+
+  if (!lock_try_acquire (&rw->lock))
+    return false;
+  success = rwlock_can_write (rw);
+  if (success)
+    rw->writer = thread_current ();
+  lock_release (&rw->lock);
+  return success;
+}
+
+/* Releases RW, which the current thread must hold for writing. */
+void
+rwlock_release_write (struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+  ASSERT (rwlock_held_for_write (rw));
+
+  lock_acquire (&rw->lock);
+  rw->writer = NULL;
+  rwlock_wake (rw);
+  lock_release (&rw->lock);
+}
+
+/* Converts the current thread's hold on RW from reading to
+   writing, sleeping until the other readers have left.  New
+   readers and writers wait while an upgrade is pending, so no
+   writer runs between the caller's read and its write.
+
+   If another reader is already upgrading, the two would wait for
+   each other forever, so this function fails at once and returns
+   false, leaving the caller holding RW for reading.  Otherwise it
+   returns true with RW held for writing. */
+bool
+rwlock_upgrade (struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+
+  lock_acquire (&rw->lock);
+  ASSERT (rw->readers > 0);
+  if (rw->upgrading)
+    {
+      lock_release (&rw->lock);
+      return false;
+    }
+  rw->upgrading = true;
+  while (rw->readers > 1)
+    cond_wait (&rw->upgrade_ok, &rw->lock);
+  rw->upgrading = false;
+  rw->readers = 0;
+  rw->writer = thread_current ();
+  lock_release (&rw->lock);
+  return true;
+}
+
+/* Converts the current thread's hold on RW from writing to
+   reading, without letting a writer in between, and lets waiting
+   readers in if the policy allows. */
+void
+rwlock_downgrade (struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+  ASSERT (rwlock_held_for_write (rw));
+
+  lock_acquire (&rw->lock);
+  rw->writer = NULL;
+  rw->readers = 1;
+  if (rw->waiting_readers > 0)
+    cond_broadcast (&rw->read_ok, &rw->lock);
+  lock_release (&rw->lock);
+}
+
+/* Returns true if the current thread holds RW for writing, false
+   otherwise.  There is no equivalent for readers, which are only
+   counted. */
+bool
+rwlock_held_for_write (const struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+
+  return rw->writer == thread_current ();
+}
+
+/* Initializes sequence lock SL. */
+void
+seqlock_init (struct seqlock *sl)
+{
+  ASSERT (sl != NULL);
+
+  sl->seq = 0;
+}
+
+/* Begins a read of the data protected by SL and returns the
+   sequence number to pass to seqlock_read_retry().  Waits for a
+   write in progress on another CPU to finish. */
+unsigned
+seqlock_read_begin (const struct seqlock *sl)
+{
+  unsigned seq;
+
+  while ((seq = sl->seq) & 1)
+    asm volatile ("pause");
+  barrier ();
+  return seq;
+}
+
+/* Returns true if the data read from SL since the
+   seqlock_read_begin() call that returned SEQ may be
+   inconsistent, so that the read must be retried. */
+bool
+seqlock_read_retry (const struct seqlock *sl, unsigned seq)
+{
+  barrier ();
+  return sl->seq != seq;
+}
+
+/* Begins a write of the data protected by SL.  Interrupts must be
+   off until the matching seqlock_write_end(). */
+void
+seqlock_write_begin (struct seqlock *sl)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT ((sl->seq & 1) == 0);
+
+  sl->seq++;
+  barrier ();
+}
+
+/* Ends a write of the data protected by SL. */
+void
+seqlock_write_end (struct seqlock *sl)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (sl->seq & 1);
+
+  barrier ();
+  sl->seq++;
+}
@@ -1,14 +1,17 @@
 #ifndef THREADS_SYNCH_H
 #define THREADS_SYNCH_H
 
+#include <heap.h>
 #include <list.h>
 #include <stdbool.h>
 
+struct thread;
+
 /* A counting semaphore. */
 struct semaphore 
   {
     unsigned value;             /* Current value. */
-    struct list waiters;        /* List of waiting threads. */
+    struct heap waiters;        /* Waiting threads, next to wake on top. */
   };
 
 void sema_init (struct semaphore *, unsigned value);
@@ -16,12 +19,14 @@ void sema_down (struct semaphore *);
 bool sema_try_down (struct semaphore *);
 void sema_up (struct semaphore *);
 void sema_self_test (void);
+void synch_waiter_changed (struct thread *);
 
 /* Lock. */
 struct lock 
   {
-    struct thread *holder;      /* Thread holding lock (for debugging). */
+    struct thread *holder;      /* Thread holding lock. */
     struct semaphore semaphore; /* Binary semaphore controlling access. */
+    struct list_elem elem;      /* Element in holder's `held_locks'. */
   };
 
 void lock_init (struct lock *);
@@ -33,7 +38,7 @@ bool lock_held_by_current_thread (const struct lock *);
 /* Condition variable. */
 struct condition 
   {
-    struct list waiters;        /* List of waiting threads. */
+    struct heap waiters;        /* Waiting threads, next to wake on top. */
   };
 
 void cond_init (struct condition *);
@@ -41,6 +46,66 @@ void cond_wait (struct condition *, struct lock *);
 void cond_signal (struct condition *, struct lock *);
 void cond_broadcast (struct condition *, struct lock *);
 
+/* Which side a reader-writer lock favors when both readers and
+   writers are waiting. */
+enum rwlock_policy
+  {
+    RWLOCK_PREFER_WRITERS,      /* Readers wait while a writer waits. */
+    RWLOCK_PREFER_READERS       /* Writers wait while any reader waits. */
+  };
+
+/* Reader-writer lock. */
+struct rwlock 
+  {
+    struct lock lock;           /* Protects the members below. */
+    struct condition read_ok;   /* Signaled when readers may enter. */
+    struct condition write_ok;  /* Signaled when a writer may enter. */
+    struct condition upgrade_ok; /* Signaled when an upgrade may finish. */
+    struct thread *writer;      /* Thread holding it for writing. */
+    int readers;                /* Number of threads holding it to read. */
+    int waiting_readers;        /* Readers waiting to enter. */
+    int waiting_writers;        /* Writers waiting to enter. */
+    bool upgrading;             /* A reader is waiting to upgrade. */
+    enum rwlock_policy policy;  /* Which side to favor. */
+  };
+
+void rwlock_init (struct rwlock *, enum rwlock_policy);
+void rwlock_acquire_read (struct rwlock *);
+bool rwlock_try_acquire_read (struct rwlock *);
+void rwlock_release_read (struct rwlock *);
+void rwlock_acquire_write (struct rwlock *);
+bool rwlock_try_acquire_write (struct rwlock *);
+void rwlock_release_write (struct rwlock *);
+bool rwlock_upgrade (struct rwlock *);
+void rwlock_downgrade (struct rwlock *);
+bool rwlock_held_for_write (const struct rwlock *);
+
+/* Sequence lock, for small data that is read far more often than
+   it is written, such as a counter updated by an interrupt
+   handler.  Readers never block or write to shared memory; they
+   copy the data and retry if a writer intervened:
+
+     unsigned seq;
+     do
+       {
+         seq = seqlock_read_begin (&sl);
+         ...copy the protected data...
+       }
+     while (seqlock_read_retry (&sl, seq));
+
+   Writers must exclude each other and must not be interrupted
+   by a reader, so they run with interrupts off. */
+struct seqlock 
+  {
+    volatile unsigned seq;      /* Odd while a write is in progress. */
+  };
+
+void seqlock_init (struct seqlock *);
+unsigned seqlock_read_begin (const struct seqlock *);
+bool seqlock_read_retry (const struct seqlock *, unsigned seq);
+void seqlock_write_begin (struct seqlock *);
+void seqlock_write_end (struct seqlock *);
+
 /* Optimization barrier.
 
    The compiler will not reorder operations across an
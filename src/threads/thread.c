@@ -2,14 +2,21 @@
 #include <debug.h>
 #include <stddef.h>
 #include <random.h>
+#include <round.h>
 #include <stdio.h>
 #include <string.h>
+#include "devices/timer.h"
+#include "threads/cpu.h"
+#include "threads/fpu.h"
+#include "threads/currency.h"
 #include "threads/flags.h"
 #include "threads/interrupt.h"
 #include "threads/intr-stubs.h"
 #include "threads/palloc.h"
+#include "threads/sched.h"
 #include "threads/switch.h"
 #include "threads/synch.h"
+#include "threads/trace.h"
 #include "threads/vaddr.h"
 #ifdef USERPROG
 #include "userprog/process.h"
@@ -21,25 +28,88 @@
    of thread.h for details. */
 #define THREAD_MAGIC 0xcd6abf4b
 
-/* List of processes in THREAD_READY state, that is, processes
-   that are ready to run but not actually running. */
-static struct list ready_list;
+/* Scheduler classes, indexed by enum scheduler_type.  The class
+   of the current scheduler owns the processes in THREAD_READY
+   state, that is, processes that are ready to run but not
+   actually running.  See sched.h. */
+static const struct sched_class *const sched_classes[] =
+  {
+    [SCHED_ROUND_ROBIN] = &sched_rr,
+    [SCHED_LOTTERY] = &sched_lottery,
+    [SCHED_STRIDE] = &sched_stride,
+  };
+static const struct sched_class *sched;
+static int ready_cnt;             /* Threads in the ready queue. */
+
+/* Returns the scheduler class that T belongs to: the EDF class
+   if T is a real-time thread, otherwise the current scheduler's
+   class. */
+static inline const struct sched_class *
+class_of (const struct thread *t)
+{
+  return t->rt_period != 0 ? &sched_edf : sched;
+}
+
+/* 4.4BSD scheduler state. */
+static fixed_point load_avg;      /* System load average. */
+static int thread_cnt;            /* Threads in all_list. */
+
+/* Once per second, every thread's recent_cpu decays by
+   DECAY_COEFF and its priority is recomputed.  With TIMER_FREQ or
+   fewer threads the whole walk of all_list happens in the timer
+   interrupt at the start of the second, as 4.4BSD specifies.
+   With more, rather than walk all_list inside a single timer
+   interrupt, the walk is spread over the following second,
+   DIV_ROUND_UP (thread_cnt, TIMER_FREQ) threads per tick,
+   starting at DECAY_CURSOR. */
+static fixed_point decay_coeff;
+static struct list_elem *decay_cursor;
 
 /* List of all processes.  Processes are added to this list
    when they are first scheduled and removed when they exit. */
 static struct list all_list;
 
+/* Index of all_list by tid, so that get_thread_by_tid() takes
+   O(1) time.  Tids are handed out in sequence, so the low bits
+   of the tid spread threads evenly over the buckets.  The list
+   elements are embedded in struct thread, so the index never
+   allocates memory. */
+#define TID_BUCKET_CNT 64
+static struct list tid_buckets[TID_BUCKET_CNT];
+
+/* Returns the tid index bucket for TID. */
+static inline struct list *
+tid_bucket (tid_t tid)
+{
+  return &tid_buckets[(unsigned) tid % TID_BUCKET_CNT];
+}
+
+/* Cache of the pages of exited threads.
+
+   Allocating a page for a new thread costs a bitmap scan in
+   palloc_get_page() and freeing one costs a 4 kB memset in debug
+   builds.  Instead, the pages of up to THREAD_CACHE_MAX exited
+   threads are kept here and handed to new threads, which need
+   only their struct thread cleared, since the stack below it is
+   written before it is read.  The cache is emptied when the
+   kernel pool runs short (see thread_cache_reclaim()).  Accessed
+   only with interrupts off. */
+#define THREAD_CACHE_MAX 32
+static void *thread_cache[THREAD_CACHE_MAX];
+static size_t thread_cache_cnt;
+static unsigned thread_cache_hits;      /* Pages taken from the cache. */
+static unsigned thread_cache_misses;    /* Pages taken from palloc. */
+
 /* Idle thread. */
 static struct thread *idle_thread;
 
 /* Initial thread, the thread running init.c:main(). */
 static struct thread *initial_thread;
 
-/* Lock used by allocate_tid(). */
-static struct lock tid_lock;
-
-static int64_t next_tick_to_awake=INT64_MAX;
-static struct list blocked_list;
+/* Sleeping threads, ordered by wake-up tick, so that the timer
+   interrupt can find the next deadline in O(1) time and wake each
+   expired thread in O(log n) time. */
+static struct heap sleep_queue;
 
 /* Stack frame for kernel_thread(). */
 struct kernel_thread_frame 
@@ -55,7 +125,7 @@ static long long kernel_ticks;  /* # of timer ticks in kernel threads. */
 static long long user_ticks;    /* # of timer ticks in user programs. */
 
 /* Scheduling. */
-#define TIME_SLICE 4            /* # of timer ticks to give each thread. */
+#define DONATION_DEPTH_MAX 8    /* Max depth of nested donation. */
 static unsigned thread_ticks;   /* # of timer ticks since last yield. */
 
 /* If false (default), use round-robin scheduler.
@@ -74,24 +144,129 @@ static void *alloc_frame (struct thread *, size_t size);
 static void schedule (void);
 void thread_schedule_tail (struct thread *prev);
 static tid_t allocate_tid (void);
-
-/******고친 부분 */
-// thread.c 맨 위쪽에 추가 (next_thread_to_run보다 위!)
-struct thread *get_thread_by_tid(tid_t tid);
+static struct thread *alloc_thread_page (void);
+static void free_thread_page (struct thread *);
+static size_t thread_cache_reclaim (void);
+static void ready_push (struct thread *);
+static void ready_remove (struct thread *);
+static bool wake_less (const struct heap_elem *, const struct heap_elem *,
+                       void *aux);
+static void thread_set_effective_priority (struct thread *, int priority);
+static bool ready_preempts (struct thread *cur);
+static void mlfqs_tick (struct thread *);
+static void mlfqs_decay_step (void);
+static int mlfqs_priority (const struct thread *);
+static void mlfqs_update_priority (struct thread *);
+
+struct thread *get_thread_by_tid (tid_t);
+
+/* Tickets given to the next thread created (see
+   thread_create_lottery()). */
 static int next_thread_tickets = 1;
-//스케쥴링 방식 
+
+/* Scheduler in use. */
 enum scheduler_type current_scheduler = SCHED_ROUND_ROBIN;
 
+/* Switches to scheduler TYPE at runtime, moving every ready
+   thread from the old scheduler class's ready queue into the new
+   one's.  The ready threads are found through all_list and
+   removed with the old class's dequeue operation, rather than by
+   draining it with pick_next, which may have side effects such as
+   charging a stride or drawing a lottery.  Interrupts stay off
+   throughout, so no thread can become ready or be picked while
+   the ready queue is split between two classes. */
 void
 set_scheduler(enum scheduler_type type) {
+  const struct sched_class *new_class;
+  struct list moved;
+  struct list_elem *e;
+  enum intr_level old_level;
+
+  ASSERT (type < sizeof sched_classes / sizeof *sched_classes);
+  new_class = sched_classes[type];
+
+  old_level = intr_disable ();
+  list_init (&moved);
+  for (e = list_begin (&all_list); e != list_end (&all_list);
+       e = list_next (e))
+    {
+      struct thread *t = list_entry (e, struct thread, allelem);
+      if (t->status == THREAD_READY && class_of (t) == sched)
+        {
+          ready_remove (t);
+          list_push_back (&moved, &t->elem);
+        }
+    }
+
   current_scheduler = type;
+  sched = new_class;
+  if (thread_current () != idle_thread && class_of (thread_current ()) == sched
+      && sched->join != NULL)
+    sched->join (thread_current ());
+  while (!list_empty (&moved))
+    {
+      struct thread *t = list_entry (list_pop_front (&moved),
+                                     struct thread, elem);
+      if (sched->join != NULL)
+        sched->join (t);
+      ready_push (t);
+    }
+  intr_set_level (old_level);
+}
+
+/* Sets the current thread's tickets, its weight under the
+   proportional-share schedulers, to TICKETS. */
+void
+thread_set_tickets (int tickets)
+{
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+
+  ASSERT (tickets > 0);
+
+  old_level = intr_disable ();
+  if (cur->ticket_active)
+    {
+      currency_deactivate (cur);
+      sched->set_weight (cur, tickets);
+      currency_activate (cur);
+    }
+  else
+    sched->set_weight (cur, tickets);
+  intr_set_level (old_level);
 }
-/* 티켓 수 내림차순 정렬용 비교 함수 */
-bool ticket_desc(const struct list_elem *a, const struct list_elem *b, void *aux UNUSED);
 
+/* Makes the running thread a real-time thread that reserves
+   RUNTIME timer ticks of CPU time in every PERIOD ticks, and is
+   scheduled ahead of all best-effort threads by earliest deadline
+   first.  Returns false, leaving the thread unchanged, if the
+   reservation does not fit alongside those of the other real-time
+   threads.  A RUNTIME of 0 cancels the reservation and makes the
+   thread best-effort again, which always succeeds. */
+bool
+thread_set_realtime (int64_t runtime, int64_t period)
+{
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+  bool success = true;
 
+  ASSERT (runtime >= 0);
+  ASSERT (runtime == 0 || runtime <= period);
 
+  old_level = intr_disable ();
+  if (runtime > 0)
+    success = edf_admit (cur, runtime, period);
+  else if (cur->rt_period != 0)
+    {
+      edf_release (cur);
+      if (sched->join != NULL)
+        sched->join (cur);
+    }
+  intr_set_level (old_level);
 
+  thread_preempt ();
+  return success;
+}
 
 /* Initializes the threading system by transforming the code
    that's currently running into a thread.  This can't work in
@@ -109,19 +284,28 @@ bool ticket_desc(const struct list_elem *a, const struct list_elem *b, void *aux
 void
 thread_init (void) 
 {
+  size_t i;
+
   ASSERT (intr_get_level () == INTR_OFF);
 
-  lock_init (&tid_lock);
-  list_init (&ready_list);
-  list_init(&blocked_list);
+  for (i = 0; i < sizeof sched_classes / sizeof *sched_classes; i++)
+    sched_classes[i]->init ();
+  sched_edf.init ();
+  sched = sched_classes[current_scheduler];
+  decay_cursor = NULL;
+  heap_init (&sleep_queue, wake_less, NULL);
   list_init (&all_list);
+  for (i = 0; i < TID_BUCKET_CNT; i++)
+    list_init (&tid_buckets[i]);
+  palloc_register_reclaim (thread_cache_reclaim);
 
   /* Set up a thread structure for the running thread. */
   initial_thread = running_thread ();
   init_thread (initial_thread, "main", PRI_DEFAULT);
   initial_thread->status = THREAD_RUNNING;
-  initial_thread->tid = allocate_tid ();
   initial_thread->tickets = 1;
+  initial_thread->stats.stamp = rdtsc ();
+  initial_thread->ticket_active = true;
   random_init(timer_ticks());  // 시드 초기화
 }
 
@@ -143,7 +327,9 @@ thread_start (void)
 }
 
 /* Called by the timer interrupt handler at each timer tick.
-   Thus, this function runs in an external interrupt context. */
+   Thus, this function runs in an external interrupt context,
+   except that the idle thread may call it to count ticks skipped
+   in dynamic-tick mode. */
 void
 thread_tick (void) 
 {
@@ -159,18 +345,101 @@ thread_tick (void)
   else
     kernel_ticks++;
 
-  /* Enforce preemption. */
-  if (++thread_ticks >= TIME_SLICE)
+  if (thread_mlfqs)
+    mlfqs_tick (t);
+  if (class_of (t)->tick != NULL && t != idle_thread)
+    class_of (t)->tick (t);
+
+  /* Enforce preemption.  The idle thread has nothing to yield
+     to, and may count skipped ticks outside the timer interrupt
+     (see timer_idle_exit()). */
+  if (++thread_ticks >= TIME_SLICE && t != idle_thread)
     intr_yield_on_return (); //현재 interrupt handler 종료 후 cpu를 양보하도록 설정
   //실제 스위칭은 이후 schedule()에서 발생
 }
 
-/* Prints thread statistics. */
+/* Counts an interval of CYCLES cycles in thread_stats histogram
+   HIST. */
+static void
+hist_add (uint16_t hist[THREAD_HIST_BUCKETS], uint64_t cycles)
+{
+  int bucket;
+
+  if (cycles >> (THREAD_HIST_SHIFT + THREAD_HIST_BUCKETS) != 0)
+    bucket = THREAD_HIST_BUCKETS - 1;
+  else if (cycles >> THREAD_HIST_SHIFT == 0)
+    bucket = 0;
+  else
+    bucket = 31 - __builtin_clz ((uint32_t) cycles) - THREAD_HIST_SHIFT;
+  if (hist[bucket] != UINT16_MAX)
+    hist[bucket]++;
+}
+
+/* Prints the nonzero buckets of histogram HIST, labeled NAME. */
+static void
+print_hist (const char *name, const uint16_t hist[THREAD_HIST_BUCKETS])
+{
+  int i;
+
+  printf ("    %s:", name);
+  for (i = 0; i < THREAD_HIST_BUCKETS; i++)
+    if (hist[i] != 0)
+      printf (" 2^%d:%u", i + THREAD_HIST_SHIFT, hist[i]);
+  printf ("\n");
+}
+
+/* Prints thread statistics, followed by the CPU accounting of
+   each live thread. */
 void
 thread_print_stats (void) 
 {
+  struct list_elem *e;
+
   printf ("Thread: %lld idle ticks, %lld kernel ticks, %lld user ticks\n",
           idle_ticks, kernel_ticks, user_ticks);
+  printf ("Thread page cache: %u hits, %u misses, %zu pages cached\n",
+          thread_cache_hits, thread_cache_misses, thread_cache_cnt);
+
+  for (e = list_begin (&all_list); e != list_end (&all_list);
+       e = list_next (e))
+    {
+      struct thread *t = list_entry (e, struct thread, allelem);
+      struct thread_stats st;
+
+      if (!thread_get_stats (t->tid, &st))
+        continue;
+      printf ("  %d %s: %u runs, %u voluntary and %u involuntary switches, "
+              "%llu cycles running, %llu cycles ready\n",
+              t->tid, t->name, st.schedules, st.voluntary, st.involuntary,
+              st.run_cycles, st.ready_cycles);
+      if (t->rt_period != 0 || st.deadline_misses != 0)
+        printf ("    real-time: %lld of every %lld ticks, "
+                "%u deadlines missed\n",
+                t->rt_runtime, t->rt_period, st.deadline_misses);
+      print_hist ("run lengths", st.run_hist);
+      print_hist ("ready latencies", st.ready_hist);
+    }
+}
+
+/* Copies the CPU accounting of the thread with the given TID into
+   *STATS.  The running thread's current run is included.  Returns
+   true if successful, false if there is no such thread. */
+bool
+thread_get_stats (tid_t tid, struct thread_stats *stats)
+{
+  enum intr_level old_level;
+  struct thread *t;
+
+  old_level = intr_disable ();
+  t = get_thread_by_tid (tid);
+  if (t != NULL)
+    {
+      *stats = t->stats;
+      if (t->status == THREAD_RUNNING)
+        stats->run_cycles += rdtsc () - t->stats.stamp;
+    }
+  intr_set_level (old_level);
+  return t != NULL;
 }
 
 /* Creates a new kernel thread named NAME with the given initial
@@ -185,9 +454,14 @@ thread_print_stats (void)
    scheduled.  Use a semaphore or some other form of
    synchronization if you need to ensure ordering.
 
-   The code provided sets the new thread's `priority' member to
-   PRIORITY, but no actual priority scheduling is implemented.
-   Priority scheduling is the goal of Problem 1-3. */
+   The new thread runs at PRIORITY, or under the 4.4BSD scheduler
+   at a priority computed from its parent's recent_cpu and nice
+   values.  The round-robin and lottery schedulers always run a
+   thread of the highest ready priority, so if the new thread
+   outranks the running thread, the running thread yields to it
+   at once; the stride scheduler ignores priority.  While the new
+   thread holds a lock, threads waiting for the lock donate their
+   priority to it. */
 tid_t
 thread_create (const char *name, int priority,
                thread_func *function, void *aux) 
@@ -201,13 +475,13 @@ thread_create (const char *name, int priority,
   ASSERT (function != NULL);
 
   /* Allocate thread. */
-  t = palloc_get_page (PAL_ZERO);
+  t = alloc_thread_page ();
   if (t == NULL)
     return TID_ERROR;
 
   /* Initialize thread. */
   init_thread (t, name, priority);
-  tid = t->tid = allocate_tid ();
+  tid = t->tid;
 
   /* Stack frame for kernel_thread(). */
   kf = alloc_frame (t, sizeof *kf);
@@ -226,21 +500,21 @@ thread_create (const char *name, int priority,
 
   /* Add to run queue. */
   thread_unblock (t);
+  thread_preempt ();
 
   return tid;
 }
 
-
 //기본 생성 함수는 1장짜리 티켓을 주고, 특정 테스트에서는 더 많이 줄 수 있게함
 tid_t thread_create_lottery(const char *name, int priority, int tickets,
                             thread_func *function, void *aux) {
+  ASSERT (tickets > 0);
   next_thread_tickets = tickets;  // 다음 스레드가 생성될 때 사용할 티켓 수 설정
   tid_t tid = thread_create(name, priority, function, aux);
   next_thread_tickets = 1;        // 다음 thread는 기본값 (1장)으로 초기화
   return tid;
 }
 
-
 /* Puts the current thread to sleep.  It will not be scheduled
    again until awoken by thread_unblock().
 
@@ -254,6 +528,7 @@ thread_block (void)
   ASSERT (intr_get_level () == INTR_OFF);
 
   thread_current ()->status = THREAD_BLOCKED;
+  TRACE (TRACE_BLOCK, thread_current ()->tid, 0);
   schedule ();
 }
 
@@ -274,8 +549,14 @@ thread_unblock (struct thread *t)
 
   old_level = intr_disable ();
   ASSERT (t->status == THREAD_BLOCKED);
-  list_insert_ordered(&ready_list, &t->elem, ticket_desc, NULL); // ← 여기!
+  if (!t->ticket_active)
+    currency_activate (t);
+  if (class_of (t)->join != NULL)
+    class_of (t)->join (t);
+  ready_push (t);
   t->status = THREAD_READY;
+  t->stats.stamp = rdtsc ();
+  TRACE (TRACE_WAKEUP, t->tid, 0);
   intr_set_level (old_level);
 }
 
@@ -322,12 +603,20 @@ thread_exit (void)
 #ifdef USERPROG
   process_exit ();
 #endif
+  fpu_release (thread_current ());
 
   /* Remove thread from all threads list, set our status to dying,
      and schedule another process.  That process will destroy us
      when it calls thread_schedule_tail(). */
   intr_disable ();
+  if (decay_cursor == &thread_current ()->allelem)
+    decay_cursor = list_next (decay_cursor);
   list_remove (&thread_current()->allelem);
+  list_remove (&thread_current ()->tidelem);
+  thread_cnt--;
+  currency_leave (thread_current ());
+  if (thread_current ()->rt_period != 0)
+    edf_release (thread_current ());
   thread_current ()->status = THREAD_DYING;
   schedule ();
   NOT_REACHED ();
@@ -345,7 +634,7 @@ thread_yield (void)
 
   old_level = intr_disable ();
   if (cur != idle_thread) 
-    list_insert_ordered(&ready_list, &cur->elem, ticket_desc, NULL);  // ← 여기!
+    ready_push (cur);
   cur->status = THREAD_READY;
   schedule ();
   intr_set_level (old_level);
@@ -368,11 +657,233 @@ thread_foreach (thread_action_func *func, void *aux)
     }
 }
 
-/* Sets the current thread's priority to NEW_PRIORITY. */
+/* Sets the current thread's base priority to NEW_PRIORITY,
+   yielding if it no longer has the highest priority.  Priority
+   donated to the current thread still applies.  Has no effect
+   under the multi-level feedback queue scheduler, which computes
+   priorities itself. */
 void
 thread_set_priority (int new_priority) 
 {
-  thread_current ()->priority = new_priority;
+  enum intr_level old_level;
+
+  ASSERT (PRI_MIN <= new_priority && new_priority <= PRI_MAX);
+
+  if (thread_mlfqs)
+    return;
+
+  old_level = intr_disable ();
+  thread_current ()->base_priority = new_priority;
+  thread_refresh_priority (thread_current ());
+  intr_set_level (old_level);
+
+  thread_preempt ();
+}
+
+/* Donates the priority of DONOR, which is about to wait for
+   DONOR->waiting_lock, to the lock's holder.  If that holder is
+   itself waiting for a lock, the donation is passed on to that
+   lock's holder, and so on, up to DONATION_DEPTH_MAX levels.
+   Interrupts must be off. */
+void
+thread_donate_priority (struct thread *donor)
+{
+  int depth;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (thread_mlfqs)
+    return;
+
+  for (depth = 0; depth < DONATION_DEPTH_MAX; depth++)
+    {
+      struct thread *holder;
+
+      if (donor->waiting_lock == NULL)
+        break;
+      holder = donor->waiting_lock->holder;
+      if (holder == NULL || holder->priority >= donor->priority)
+        break;
+
+      thread_set_effective_priority (holder, donor->priority);
+      donor = holder;
+    }
+}
+
+/* Recomputes T's effective priority as the maximum of its base
+   priority and the priorities of the threads waiting for the
+   locks that T holds.  Called when T releases a lock or changes
+   its base priority.  Interrupts must be off. */
+void
+thread_refresh_priority (struct thread *t)
+{
+  int priority = t->base_priority;
+  struct list_elem *e;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (thread_mlfqs)
+    return;
+
+  for (e = list_begin (&t->held_locks); e != list_end (&t->held_locks);
+       e = list_next (e))
+    {
+      struct lock *lock = list_entry (e, struct lock, elem);
+      struct heap *waiters = &lock->semaphore.waiters;
+
+      if (!heap_empty (waiters))
+        {
+          struct thread *waiter = heap_entry (heap_top (waiters),
+                                              struct thread, wait_elem);
+          if (waiter->priority > priority)
+            priority = waiter->priority;
+        }
+    }
+  thread_set_effective_priority (t, priority);
+}
+
+/* Transfers the lottery tickets of DONOR, which is about to wait
+   for DONOR->waiting_lock, to the lock's holder, so that the
+   holder runs at least as often as DONOR would have.  As with
+   priority donation, the transfer is passed on if the holder is
+   itself waiting for a lock, up to DONATION_DEPTH_MAX levels.
+   Interrupts must be off. */
+void
+thread_transfer_tickets (struct thread *donor)
+{
+  int tickets = lottery_value (donor);
+  int depth;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  for (depth = 0; depth < DONATION_DEPTH_MAX; depth++)
+    {
+      struct thread *holder;
+
+      if (donor->waiting_lock == NULL)
+        break;
+      holder = donor->waiting_lock->holder;
+      if (holder == NULL)
+        break;
+      holder->transfer_tickets += tickets;
+      thread_tickets_changed (holder);
+      donor = holder;
+    }
+}
+
+/* Adds the lottery value of the waiting thread whose `wait_elem'
+   is E to the int that TOTAL points to. */
+static void
+add_waiter_tickets (struct heap_elem *e, void *total)
+{
+  *(int *) total += lottery_value (heap_entry (e, struct thread, wait_elem));
+}
+
+/* Recomputes the tickets transferred to T as the total value of
+   the threads waiting for the locks that T holds.  Called when T
+   acquires or releases a lock.  Interrupts must be off. */
+void
+thread_refresh_tickets (struct thread *t)
+{
+  int tickets = 0;
+  struct list_elem *e;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  for (e = list_begin (&t->held_locks); e != list_end (&t->held_locks);
+       e = list_next (e))
+    {
+      struct lock *lock = list_entry (e, struct lock, elem);
+
+      heap_apply (&lock->semaphore.waiters, add_waiter_tickets, &tickets);
+    }
+  if (tickets != t->transfer_tickets)
+    {
+      t->transfer_tickets = tickets;
+      thread_tickets_changed (t);
+    }
+}
+
+/* Called when the value of T's lottery tickets may have changed.
+   If T is in the lottery ready queue, requeues it with its new
+   value, which keeps the ticket totals in the queue exact.  If T
+   is blocked, moves it to its new place in any wait queue.
+   Interrupts must be off. */
+void
+thread_tickets_changed (struct thread *t)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (t->status == THREAD_READY && class_of (t) == &sched_lottery)
+    {
+      ready_remove (t);
+      ready_push (t);
+    }
+  else if (t->status == THREAD_BLOCKED)
+    synch_waiter_changed (t);
+}
+
+/* Returns the number of base tickets with which the thread with
+   the given TID currently competes in the lottery, counting
+   currency conversion and transfers but not compensation, or -1
+   if there is no such thread. */
+int
+thread_get_tickets (tid_t tid)
+{
+  enum intr_level old_level;
+  struct thread *t;
+  int tickets = -1;
+
+  old_level = intr_disable ();
+  t = get_thread_by_tid (tid);
+  if (t != NULL)
+    tickets = lottery_value (t);
+  intr_set_level (old_level);
+  return tickets;
+}
+
+/* Yields the CPU if a ready thread has a higher priority than the
+   running thread.  In an interrupt handler, the yield happens
+   just before the handler returns. */
+void
+thread_preempt (void)
+{
+  enum intr_level old_level;
+  bool yield;
+
+  old_level = intr_disable ();
+  yield = (thread_current () != idle_thread
+           && ready_preempts (thread_current ()));
+  intr_set_level (old_level);
+
+  if (!yield)
+    return;
+  if (intr_context ())
+    intr_yield_on_return ();
+  else
+    thread_yield ();
+}
+
+/* Sets T's effective priority to PRIORITY, moving T to the right
+   place in the ready queue if it is ready.  Interrupts must be
+   off. */
+static void
+thread_set_effective_priority (struct thread *t, int priority)
+{
+  if (t->priority == priority)
+    return;
+  if (t->status == THREAD_READY)
+    {
+      ready_remove (t);
+      t->priority = priority;
+      ready_push (t);
+    }
+  else
+    {
+      t->priority = priority;
+      if (t->status == THREAD_BLOCKED)
+        synch_waiter_changed (t);
+    }
 }
 
 /* Returns the current thread's priority. */
@@ -382,35 +893,54 @@ thread_get_priority (void)
   return thread_current ()->priority;
 }
 
-/* Sets the current thread's nice value to NICE. */
+/* Sets the current thread's nice value to NICE and recomputes
+   its priority, yielding if it no longer has the highest
+   priority. */
 void
-thread_set_nice (int nice UNUSED) 
+thread_set_nice (int nice) 
 {
-  /* Not yet implemented. */
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+  bool yield;
+
+  ASSERT (NICE_MIN <= nice && nice <= NICE_MAX);
+
+  old_level = intr_disable ();
+  cur->nice = nice;
+  if (thread_mlfqs)
+    mlfqs_update_priority (cur);
+  yield = thread_mlfqs && ready_preempts (cur);
+  intr_set_level (old_level);
+
+  if (yield)
+    thread_yield ();
 }
 
 /* Returns the current thread's nice value. */
 int
 thread_get_nice (void) 
 {
-  /* Not yet implemented. */
-  return 0;
+  return thread_current ()->nice;
 }
 
 /* Returns 100 times the system load average. */
 int
 thread_get_load_avg (void) 
 {
-  /* Not yet implemented. */
-  return 0;
+  enum intr_level old_level = intr_disable ();
+  int load_avg_100 = fp_round (load_avg * 100);
+  intr_set_level (old_level);
+  return load_avg_100;
 }
 
 /* Returns 100 times the current thread's recent_cpu value. */
 int
 thread_get_recent_cpu (void) 
 {
-  /* Not yet implemented. */
-  return 0;
+  enum intr_level old_level = intr_disable ();
+  int recent_cpu_100 = fp_round (thread_current ()->recent_cpu * 100);
+  intr_set_level (old_level);
+  return recent_cpu_100;
 }
 
 /* Idle thread.  Executes when no other thread is ready to run.
@@ -431,10 +961,27 @@ idle (void *idle_started_ UNUSED)
 
   for (;;) 
     {
-      /* Let someone else run. */
+      /* Catch up any ticks skipped while halted, then let
+         someone else run. */
       intr_disable ();
+      timer_idle_exit ();
       thread_block ();
 
+      /* With nothing else ready, fill the stocks of pre-zeroed
+         pages, a page at a time, checking between pages whether
+         a thread has become ready.  The idle thread is never
+         preempted, so if one has, block again to run it instead
+         of halting. */
+      if (ready_cnt == 0)
+        {
+          intr_enable ();
+          while (ready_cnt == 0 && palloc_zero_idle ())
+            continue;
+          intr_disable ();
+          if (ready_cnt > 0)
+            continue;
+        }
+
       /* Re-enable interrupts and wait for the next one.
 
          The `sti' instruction disables interrupts until the
@@ -447,6 +994,7 @@ idle (void *idle_started_ UNUSED)
 
          See [IA32-v2a] "HLT", [IA32-v2b] "STI", and [IA32-v3a]
          7.11.1 "HLT Instruction". */
+      timer_idle_enter ();
       asm volatile ("sti; hlt" : : : "memory");
     }
 }
@@ -484,26 +1032,53 @@ is_thread (struct thread *t)
 }
 
 /* Does basic initialization of T as a blocked thread named
-   NAME. */
+   NAME, and gives it a tid. */
 static void
 init_thread (struct thread *t, const char *name, int priority)
 {
+  enum intr_level old_level;
+
   ASSERT (t != NULL);
   ASSERT (PRI_MIN <= priority && priority <= PRI_MAX);
   ASSERT (name != NULL);
 
   memset (t, 0, sizeof *t);
+  t->tid = allocate_tid ();
   t->status = THREAD_BLOCKED;
   strlcpy (t->name, name, sizeof t->name);
   t->stack = (uint8_t *) t + PGSIZE;
-  t->priority = priority;
+  t->priority = t->base_priority = priority;
+  list_init (&t->held_locks);
   t->tick_to_awake = INT64_MAX;//새 스레드가 생성될 때, tick_to_awake 값을 미리최대값으로 초기화
  //tick_to_awake값은 thread_sleep()에서 바뀜
   t->magic = THREAD_MAGIC;
   t->tickets = next_thread_tickets;
   t->perf_id=0;
+  if (thread_mlfqs)
+    {
+      /* A new thread inherits its parent's nice and recent_cpu,
+         and its priority is computed from them. */
+      struct thread *parent = running_thread ();
+      if (parent != t)
+        {
+          t->nice = parent->nice;
+          t->recent_cpu = parent->recent_cpu;
+        }
+      t->priority = mlfqs_priority (t);
+    }
+  old_level = intr_disable ();
   list_push_back (&all_list, &t->allelem);
+  list_push_front (tid_bucket (t->tid), &t->tidelem);
+  thread_cnt++;
+  intr_set_level (old_level);
 
+  /* A new thread holds its tickets in its creator's currency. */
+  if (running_thread () != t && running_thread ()->currency != NULL)
+    {
+      enum intr_level old_level = intr_disable ();
+      currency_join (running_thread ()->currency, t);
+      intr_set_level (old_level);
+    }
 }
 
 /* Allocates a SIZE-byte frame at the top of thread T's stack and
@@ -524,88 +1099,188 @@ alloc_frame (struct thread *t, size_t size)
    empty.  (If the running thread can continue running, then it
    will be in the run queue.)  If the run queue is empty, return
    idle_thread. */
-// threads/scheduler.c
 static struct thread *
-next_thread_to_run(void) {
-  if (list_empty(&ready_list))
+next_thread_to_run (void)
+{
+  struct thread *t = sched_edf.pick_next ();
+
+  if (t == NULL)
+    t = sched->pick_next ();
+  if (t == NULL)
     return idle_thread;
+  ready_cnt--;
+  return t;
+}
+
+/* Adds T to the ready queue of the current scheduler.
+   Interrupts must be off. */
+static void
+ready_push (struct thread *t)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
 
-  if (current_scheduler == SCHED_ROUND_ROBIN)
-    return list_entry(list_pop_front(&ready_list), struct thread, elem);
+  class_of (t)->enqueue (t);
+  ready_cnt++;
+}
 
-  else if (current_scheduler == SCHED_LOTTERY) {
-     struct thread *next = pick_lottery_thread();
+/* Removes T, which must be ready, from the ready queue of the
+   current scheduler.  Interrupts must be off. */
+static void
+ready_remove (struct thread *t)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (t->status == THREAD_READY);
 
-    // 스레드가 성능 측정 대상이면 count 증가
-    //count[next->perf_id]++;
+  class_of (t)->dequeue (t);
+  ready_cnt--;
+}
 
-    return next;
-  }
+/* Returns true if a ready thread should preempt CUR, the running
+   thread: a real-time thread with an earlier deadline, or, if CUR
+   is not a real-time thread, one with a higher priority.
+   Interrupts must be off. */
+static bool
+ready_preempts (struct thread *cur)
+{
+  return (edf_preempts (cur)
+          || (cur->rt_period == 0 && sched->max_priority () > cur->priority));
 }
 
-struct thread *pick_lottery_thread(void) {
-  if (list_empty(&ready_list))
-    return idle_thread;
+/* Returns the 4.4BSD priority of T, computed from its recent_cpu
+   and nice values. */
+static int
+mlfqs_priority (const struct thread *t)
+{
+  int priority = PRI_MAX - fp_trunc (t->recent_cpu / 4) - t->nice * 2;
 
-  struct list_elem *e;
-  int max_priority = PRI_MIN;
-
-  // [1] Find max priority
-  for (e = list_begin(&ready_list); e != list_end(&ready_list); e = list_next(e)) {
-    struct thread *t = list_entry(e, struct thread, elem);
-    if (t->priority > max_priority)
-      max_priority = t->priority;
-  }
-
-  // [2] Collect candidates with max priority
-  struct thread *candidates[64];   // assuming max 64 threads
-  int tickets[64];
-  int countt = 0;
-  int total_tickets = 0;
-
-  for (e = list_begin(&ready_list); e != list_end(&ready_list); e = list_next(e)) {
-    struct thread *t = list_entry(e, struct thread, elem);
-    if (t->priority == max_priority && countt < 64) {
-      candidates[countt] = t;
-      tickets[countt] = t->tickets;
-      total_tickets += t->tickets;
-      countt++;
-    }
-  }
-
-  if (total_tickets == 0 || countt == 0) {
-    // fallback: 그냥 첫 번째 스레드 실행
-    return list_entry(list_pop_front(&ready_list), struct thread, elem);
-  }
-
-  // [3] Draw lottery among candidates
-  int winner = random_ulong() % total_tickets + 1;
-  for (int i = 0; i < countt; i++) {
-    if (winner <= tickets[i]) {
-      list_remove(&candidates[i]->elem);
-      return candidates[i];
+  if (priority < PRI_MIN)
+    return PRI_MIN;
+  else if (priority > PRI_MAX)
+    return PRI_MAX;
+  return priority;
+}
+
+/* Recomputes T's priority, moving it to the right ready list if
+   it is ready.  Interrupts must be off. */
+static void
+mlfqs_update_priority (struct thread *t)
+{
+  thread_set_effective_priority (t, mlfqs_priority (t));
+}
+
+/* Does the multi-level feedback queue scheduler's work for a
+   timer tick during which CUR was running. */
+static void
+mlfqs_tick (struct thread *cur)
+{
+  int64_t now = timer_ticks ();
+
+  if (cur != idle_thread)
+    cur->recent_cpu = fp_add_int (cur->recent_cpu, 1);
+
+  if (now % TIMER_FREQ == 0)
+    {
+      int ready_threads = ready_cnt + (cur != idle_thread);
+      fixed_point twice_load;
+
+      load_avg = (59 * load_avg + fp_from_int (ready_threads)) / 60;
+      twice_load = 2 * load_avg;
+      decay_coeff = fp_div (twice_load, fp_add_int (twice_load, 1));
+      decay_cursor = list_begin (&all_list);
     }
-    winner -= tickets[i];
-  }
+  mlfqs_decay_step ();
 
-  // fallback: 안전장치
-  return list_entry(list_pop_front(&ready_list), struct thread, elem);
+  /* Only the running thread's recent_cpu changes between decays,
+     so it is the only priority that needs refreshing here. */
+  if (now % 4 == 0 && cur != idle_thread)
+    {
+      mlfqs_update_priority (cur);
+      if (ready_preempts (cur))
+        intr_yield_on_return ();
+    }
 }
 
+/* Decays recent_cpu and recomputes the priority of the next batch
+   of threads in the once-per-second walk of all_list: all of them
+   if there are TIMER_FREQ or fewer threads, otherwise a
+   TIMER_FREQ'th of them. */
+static void
+mlfqs_decay_step (void)
+{
+  int batch = (thread_cnt <= TIMER_FREQ
+               ? thread_cnt : DIV_ROUND_UP (thread_cnt, TIMER_FREQ));
 
+  while (batch-- > 0 && decay_cursor != NULL
+         && decay_cursor != list_end (&all_list))
+    {
+      struct thread *t = list_entry (decay_cursor, struct thread, allelem);
+
+      decay_cursor = list_next (decay_cursor);
+      if (t == idle_thread)
+        continue;
+      t->recent_cpu = fp_add_int (fp_mul (decay_coeff, t->recent_cpu),
+                                  t->nice);
+      mlfqs_update_priority (t);
+    }
+}
 
-//또 추가
-/* Find thread by tid from all_list. */
-struct thread *get_thread_by_tid(tid_t tid) {
+/* Returns the thread with the given TID, or a null pointer if
+   there is none.  Interrupts must be off, so that the thread
+   cannot exit while the caller uses it. */
+struct thread *
+get_thread_by_tid (tid_t tid)
+{
+  struct list *bucket = tid_bucket (tid);
   struct list_elem *e;
-  for (e = list_begin(&all_list); e != list_end(&all_list); e = list_next(e)) {
-    struct thread *t = list_entry(e, struct thread, allelem);
-    if (t->tid == tid)
-      return t;
-  }
-  return NULL;  // 못 찾은 경우
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  for (e = list_begin (bucket); e != list_end (bucket); e = list_next (e))
+    {
+      struct thread *t = list_entry (e, struct thread, tidelem);
+      if (t->tid == tid)
+        return t;
+    }
+  return NULL;
 }
 
+/* Ends the accounting of the run of CUR, which is being switched
+   away from.  Returns the length of the run in cycles. */
+static uint64_t
+account_run_end (struct thread *cur)
+{
+  struct thread_stats *st = &cur->stats;
+  uint64_t now = rdtsc ();
+  uint64_t ran = now - st->stamp;
+
+  st->run_cycles += ran;
+  hist_add (st->run_hist, ran);
+  if (cur->status == THREAD_READY)
+    st->involuntary++;
+  else
+    st->voluntary++;
+  st->stamp = now;
+  return ran;
+}
+
+/* Starts the accounting of a run of CUR, which has just been
+   switched to, charging the time since it became ready. */
+static void
+account_run_start (struct thread *cur)
+{
+  struct thread_stats *st = &cur->stats;
+  uint64_t now = rdtsc ();
+
+  /* The idle thread is never ready, only blocked. */
+  if (cur != idle_thread)
+    {
+      uint64_t waited = now - st->stamp;
+      st->ready_cycles += waited;
+      hist_add (st->ready_hist, waited);
+    }
+  st->schedules++;
+  st->stamp = now;
+}
 
 /* Completes a thread switch by activating the new thread's page
    tables, and, if the previous thread is dying, destroying it.
@@ -632,6 +1307,8 @@ thread_schedule_tail (struct thread *prev)
 
   /* Mark us as running. */
   cur->status = THREAD_RUNNING;
+  account_run_start (cur);
+  fpu_switch (cur);
 
   /* Start new time slice. */
   thread_ticks = 0;
@@ -649,7 +1326,7 @@ thread_schedule_tail (struct thread *prev)
   if (prev != NULL && prev->status == THREAD_DYING && prev != initial_thread) 
     {
       ASSERT (prev != cur);
-      palloc_free_page (prev);
+      free_thread_page (prev);
     }
 }
 
@@ -657,132 +1334,175 @@ static void
 schedule (void) 
 {
   struct thread *cur = running_thread ();
-  struct thread *next = next_thread_to_run ();
+  struct thread *next;
   struct thread *prev = NULL;
+  uint64_t ran;
+
+  ran = account_run_end (cur);
+
+  /* A thread blocked on a lock keeps its tickets active, because
+     they fund the lock's holder. */
+  if (cur->ticket_active
+      && (cur->status == THREAD_DYING
+          || (cur->status == THREAD_BLOCKED && cur->waiting_lock == NULL)))
+    currency_deactivate (cur);
+  if (class_of (cur)->yield != NULL && cur != idle_thread)
+    class_of (cur)->yield (cur, ran);
+  next = next_thread_to_run ();
 
   ASSERT (intr_get_level () == INTR_OFF);
   ASSERT (cur->status != THREAD_RUNNING);
   ASSERT (is_thread (next));
 
+  TRACE (TRACE_SWITCH, cur->tid, next->tid);
   if (cur != next)
     prev = switch_threads (cur, next);
 
   thread_schedule_tail (prev);
 }
 
-/* Returns a tid to use for a new thread. */
-static tid_t
-allocate_tid (void) 
+/* Returns a page for a new thread, from the thread page cache if
+   possible, or a null pointer if memory is exhausted.  Only the
+   struct thread at the start of the page is cleared, by
+   init_thread(). */
+static struct thread *
+alloc_thread_page (void)
 {
-  static tid_t next_tid = 1;
-  tid_t tid;
+  enum intr_level old_level;
+  struct thread *t = NULL;
 
-  lock_acquire (&tid_lock);
-  tid = next_tid++;
-  lock_release (&tid_lock);
+  old_level = intr_disable ();
+  if (thread_cache_cnt > 0)
+    {
+      t = thread_cache[--thread_cache_cnt];
+      thread_cache_hits++;
+    }
+  else
+    thread_cache_misses++;
+  intr_set_level (old_level);
 
-  return tid;
+  return t != NULL ? t : palloc_get_page (0);
 }
-
-/* Offset of `stack' member within `struct thread'.
-   Used by switch.S, which can't figure it out on its own. */
-uint32_t thread_stack_ofs = offsetof (struct thread, stack);
 
-void thread_sleep(int64_t ticks)
+/* Frees T, the page of a thread that has exited, into the thread
+   page cache, or back to palloc if the cache is full.  Interrupts
+   must be off. */
+static void
+free_thread_page (struct thread *t)
 {
-  struct thread *cur=thread_current(); //현재 실행 중인 스레드의 struct thread*을 받아온다
-  //인터럽트 상태 저장용 변수
- enum intr_level old_level;
-
-  ASSERT(!intr_context ()); 
-  /*
-  이 함수는 interrupt handler안에서 호출되면 안 됨
-  일반적인 thread실행 흐름 안 에서만 thread_sleep() 부를 수 있게 보장
-  */
-  
-  old_level = intr_disable();
-
-  if (cur!=idle_thread){ //idle_thread는 sleep대상이 될 수 없음
-    cur->tick_to_awake = ticks; // ✅ 현재 시간 + sleep 시간
-//현재 thread가 언제 깨어나야 하는지 저장
-    //ticks=timer_ticks()+sleep_time 
-    list_push_back(&blocked_list,&cur->elem);
-  }
-
-
-  update_next_tick_to_awake();
-  /*이 함수는 blocked_list 안에 있는 모든 스레드의 tick_to_awake 중에서
-가장 작은 값을 찾아 전역 변수 next_tick_to_awake에 저장함*/
-
-  cur->status=THREAD_BLOCKED;
-  schedule(); //->cpu를 다른 ready thread에 넘김-이 시점부터는 현제 thread는 잠들어 있는 상태
-  intr_set_level(old_level);
+  ASSERT (intr_get_level () == INTR_OFF);
 
+  if (thread_cache_cnt < THREAD_CACHE_MAX)
+    {
+#ifndef NDEBUG
+      memset (t, 0xcc, sizeof *t);
+#endif
+      thread_cache[thread_cache_cnt++] = t;
+    }
+  else
+    palloc_free_page (t);
 }
 
-  /*목표: blocked_list에 있는 모든 스레드 중에서
-tick_to_awake <= ticks 인 애들을 깨워서 ready_list로 옮김
-
-*/
-void thread_awake(int64_t ticks) {
-  struct list_elem *e = list_begin(&blocked_list);
-
-  while (e != list_end(&blocked_list)) {
-    struct thread *t = list_entry(e, struct thread, elem);
-
-    if (t->tick_to_awake <= ticks) {
-      e=list_remove(e);
-      t->tick_to_awake=0;
+/* Empties the thread page cache into palloc.  Returns the number
+   of pages freed. */
+static size_t
+thread_cache_reclaim (void)
+{
+  size_t freed = 0;
 
-      enum intr_level old_level;
-      ASSERT(is_thread(t));
-      old_level=intr_disable();
-      
-      ASSERT(t->status == THREAD_BLOCKED);
-      list_push_back(&ready_list, &t->elem);
-      t->status = THREAD_READY;
-      intr_set_level(old_level);
-    }
-    else{
-      e=list_next(e);
+  for (;;)
+    {
+      enum intr_level old_level = intr_disable ();
+      void *page = NULL;
+      if (thread_cache_cnt > 0)
+        page = thread_cache[--thread_cache_cnt];
+      intr_set_level (old_level);
+
+      if (page == NULL)
+        return freed;
+      palloc_free_page (page);
+      freed++;
     }
-
-  }
-
-  update_next_tick_to_awake();
 }
 
+/* Returns a tid to use for a new thread.  Never sleeps, so it
+   may be called before thread_init() finishes. */
+static tid_t
+allocate_tid (void) 
+{
+  static volatile tid_t next_tid = 1;
 
+  return atomic_fetch_add (&next_tid, 1);
+}
+
+/* Offset of `stack' member within `struct thread'.
+   Used by switch.S, which can't figure it out on its own. */
+uint32_t thread_stack_ofs = offsetof (struct thread, stack);
 
-void update_next_tick_to_awake(void) {
-  struct list_elem *e;
+/* Puts the current thread to sleep until the timer reaches tick
+   TICKS.  The thread is woken by thread_awake().  This function
+   must not be called from an interrupt handler. */
+void
+thread_sleep (int64_t ticks)
+{
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
 
-  if(list_empty(&blocked_list)){
-  next_tick_to_awake = INT64_MAX; // ✅ 항상 초기화해줘야 함!!
-  }
+  ASSERT (!intr_context ());
+  ASSERT (cur != idle_thread);
 
-  for (e = list_begin(&blocked_list); e != list_end(&blocked_list); e = list_next(e)) {
-    struct thread *t = list_entry(e, struct thread, elem);
+  old_level = intr_disable ();
+  cur->tick_to_awake = ticks;
+  heap_push (&sleep_queue, &cur->sleep_elem);
+  TRACE (TRACE_SLEEP, cur->tid, ticks);
+  thread_block ();
+  intr_set_level (old_level);
+}
 
-    if (t->tick_to_awake < next_tick_to_awake) {
-      next_tick_to_awake = t->tick_to_awake;
+/* Wakes up every sleeping thread whose wake-up tick is TICKS or
+   earlier.  Called from the timer interrupt handler. */
+void
+thread_awake (int64_t ticks)
+{
+  while (!heap_empty (&sleep_queue))
+    {
+      struct thread *t = heap_entry (heap_top (&sleep_queue),
+                                     struct thread, sleep_elem);
+      if (t->tick_to_awake > ticks)
+        break;
+      heap_pop (&sleep_queue);
+      t->tick_to_awake = INT64_MAX;
+      TRACE (TRACE_AWAKE, t->tid, ticks);
+      thread_unblock (t);
     }
-  }
+
+  /* A real-time thread that wakes up runs at once. */
+  if (intr_context () && edf_preempts (thread_current ()))
+    intr_yield_on_return ();
 }
 
-int64_t get_next_tick_to_awake(void){ // 다음으로 깨어나야 할 tick 값을 반환
-  if(list_empty(&blocked_list)){
-    next_tick_to_awake=INT64_MAX;
-  }
-  return next_tick_to_awake;
+/* Returns the tick at which the next sleeping thread must be
+   woken, or INT64_MAX if no thread is asleep. */
+int64_t
+get_next_tick_to_awake (void)
+{
+  if (heap_empty (&sleep_queue))
+    return INT64_MAX;
+  return heap_entry (heap_top (&sleep_queue),
+                     struct thread, sleep_elem)->tick_to_awake;
 }
 
-//lottery-desc-order추가 부분
-/* 티켓 수 내림차순 정렬용 비교 함수 */
-bool ticket_desc(const struct list_elem *a, const struct list_elem *b, void *aux UNUSED) {
-  struct thread *ta = list_entry(a, struct thread, elem);
-  struct thread *tb = list_entry(b, struct thread, elem);
-  if (ta->priority != tb->priority)
-    return ta->priority > tb->priority;
-  return ta->tickets > tb->tickets;
-}
\ No newline at end of file
+/* Returns true if thread A_ must wake up before thread B_.
+   Threads with equal deadlines are ordered by tid, so that
+   simultaneous sleepers wake in a repeatable order. */
+static bool
+wake_less (const struct heap_elem *a_, const struct heap_elem *b_,
+           void *aux UNUSED)
+{
+  const struct thread *a = heap_entry (a_, struct thread, sleep_elem);
+  const struct thread *b = heap_entry (b_, struct thread, sleep_elem);
+
+  if (a->tick_to_awake != b->tick_to_awake)
+    return a->tick_to_awake < b->tick_to_awake;
+  return a->tid < b->tid;
+}
@@ -3,8 +3,11 @@
 
 
 #include <debug.h>
+#include <heap.h>
 #include <list.h>
 #include <stdint.h>
+#include "threads/fixed-point.h"
+#include "threads/lottery_rbt.h"
 
 /* States in a thread's life cycle. */
 enum thread_status
@@ -25,6 +28,39 @@ typedef int tid_t;
 #define PRI_DEFAULT 31                  /* Default priority. */
 #define PRI_MAX 63                      /* Highest priority. */
 
+/* Thread niceness, for the multi-level feedback queue scheduler. */
+#define NICE_MIN -20                    /* Nicest to other threads. */
+#define NICE_DEFAULT 0                  /* Default niceness. */
+#define NICE_MAX 20                     /* Least nice. */
+
+struct currency;
+
+/* Number of buckets in a thread_stats histogram, and the log2
+   of the cycles at the low end of the first.  Bucket I counts
+   intervals of 2**(I+SHIFT) to 2**(I+SHIFT+1) - 1 cycles; the
+   first bucket also counts everything shorter, the last
+   everything longer.  The counters stop at UINT16_MAX.  Both are
+   kept small because the histograms live in struct thread. */
+#define THREAD_HIST_BUCKETS 16
+#define THREAD_HIST_SHIFT 10
+
+/* Per-thread CPU accounting, in time-stamp counter cycles.
+   A switch away from a thread that can still run (it yielded or
+   was preempted) is involuntary; a switch away from a thread
+   that blocked or exited is voluntary, as in getrusage(). */
+struct thread_stats
+  {
+    uint64_t run_cycles;                /* Total time running. */
+    uint64_t ready_cycles;              /* Total time ready, not running. */
+    uint64_t stamp;                     /* When the current state began. */
+    unsigned schedules;                 /* Times scheduled to run. */
+    unsigned voluntary;                 /* Voluntary switches away. */
+    unsigned involuntary;               /* Involuntary switches away. */
+    unsigned deadline_misses;           /* Real-time deadlines missed. */
+    uint16_t run_hist[THREAD_HIST_BUCKETS];   /* Lengths of runs. */
+    uint16_t ready_hist[THREAD_HIST_BUCKETS]; /* Ready-to-run latencies. */
+  };
+
 /* A kernel thread or user process.
 
    Each thread structure is stored in its own 4 kB page.  The
@@ -75,12 +111,9 @@ typedef int tid_t;
    the `magic' member of the running thread's `struct thread' is
    set to THREAD_MAGIC.  Stack overflow will normally change this
    value, triggering the assertion. */
-/* The `elem' member has a dual purpose.  It can be an element in
-   the run queue (thread.c), or it can be an element in a
-   semaphore wait list (synch.c).  It can be used these two ways
-   only because they are mutually exclusive: only a thread in the
-   ready state is on the run queue, whereas only a thread in the
-   blocked state is on a semaphore wait list. */
+/* The `elem' member is an element in the run queue (thread.c).
+   A blocked thread waits in a semaphore's wait queue through
+   `wait_elem' instead (synch.c). */
 struct thread
   {
     /* Owned by thread.c. */
@@ -88,17 +121,47 @@ struct thread
     enum thread_status status;          /* Thread state. */
     char name[16];                      /* Name (for debugging purposes). */
     uint8_t *stack;                     /* Saved stack pointer. */
-    int priority;                       /* Priority. */
+    int priority;                       /* Effective priority. */
+    int base_priority;                  /* Priority before donations. */
+    int nice;                           /* Niceness, for the MLFQS. */
+    fixed_point recent_cpu;             /* Recent CPU time, for the MLFQS. */
     struct list_elem allelem;           /* List element for all threads list. */
+    struct list_elem tidelem;           /* List element for tid index. */
+    void *fpu_state;                    /* FPU save area, or null (fpu.c). */
     
     int64_t tick_to_awake; //각 thread가 언제 께어나야하는지 저장
+    struct heap_elem sleep_elem;        /* Sleep queue element (thread.c). */
 
 
     /* Shared between thread.c and synch.c. */
+    struct list held_locks;             /* Locks held, for donation. */
+    struct lock *waiting_lock;          /* Lock being waited for, or null. */
+
+    /* Owned by synch.c. */
+    struct heap_elem wait_elem;         /* Semaphore wait queue element. */
+    struct semaphore *waiting_sema;     /* Semaphore waited for, or null. */
+    struct semaphore_elem *waiting_cond; /* Condition wait, or null. */
+    int wait_tickets;                   /* Tickets when queued. */
+    unsigned wait_seq;                  /* Order in which queued. */
     struct list_elem elem;             //elem은 thread가 ready_list나 blocked_list에 들어갔을 때, 그 리스트에서의 자기 위치(노드) 역할을 해주는 필드
 
     int tickets;   // 기본 값 1, 추후 값 바꾸는 것  가능
+    int comp_tickets;                   /* Lottery compensation tickets. */
+    int transfer_tickets;               /* Tickets funded by lock waiters. */
+    struct currency *currency;          /* Currency of `tickets', or null. */
+    struct list_elem currency_elem;     /* Element in currency's members. */
+    bool ticket_active;                 /* Counted as active in currency. */
+    struct ticket_node ticket_elem;     /* Lottery ready queue node (thread.c). */
+    struct heap_elem stride_elem;       /* Stride ready queue element. */
+    int64_t pass;                       /* Stride scheduler pass value. */
+    int64_t pass_remain;                /* Pass left over when blocked. */
+    int64_t rt_runtime;                 /* Real-time budget per period. */
+    int64_t rt_period;                  /* Real-time period, or 0. */
+    int64_t rt_deadline;                /* Real-time absolute deadline. */
+    int64_t rt_budget;                  /* Budget left before deadline. */
+    struct heap_elem rt_elem;           /* EDF ready queue element. */
     int perf_id;
+    struct thread_stats stats;          /* CPU accounting (thread.c). */
 #ifdef USERPROG
     /* Owned by userprog/process.c. */
     uint32_t *pagedir;   
@@ -121,9 +184,12 @@ void thread_start (void);
 
 void thread_tick (void);
 void thread_print_stats (void);
+bool thread_get_stats (tid_t, struct thread_stats *);
 
 typedef void thread_func (void *aux);
 tid_t thread_create (const char *name, int priority, thread_func *, void *);
+tid_t thread_create_lottery (const char *name, int priority, int tickets,
+                             thread_func *, void *);
 
 void thread_block (void);
 void thread_unblock (struct thread *);
@@ -141,6 +207,13 @@ void thread_foreach (thread_action_func *, void *);
 
 int thread_get_priority (void);
 void thread_set_priority (int);
+void thread_donate_priority (struct thread *);
+void thread_refresh_priority (struct thread *);
+void thread_preempt (void);
+void thread_transfer_tickets (struct thread *);
+void thread_refresh_tickets (struct thread *);
+void thread_tickets_changed (struct thread *);
+int thread_get_tickets (tid_t);
 
 int thread_get_nice (void);
 void thread_set_nice (int);
@@ -149,19 +222,19 @@ int thread_get_load_avg (void);
 
 void thread_sleep(int64_t ticks);
 void thread_awake(int64_t ticks);
-void update_next_tick_to_awake(void);
 int64_t get_next_tick_to_awake(void);
 
 
 
 enum scheduler_type {
   SCHED_ROUND_ROBIN, //0
-  SCHED_LOTTERY//1
-  
+  SCHED_LOTTERY, //1
+  SCHED_STRIDE   /* Deterministic proportional share by tickets. */
 };
 void set_scheduler(enum scheduler_type type);
 extern enum scheduler_type current_scheduler; //현재 스케쥴링 방식
-struct thread *pick_lottery_thread(void);
+void thread_set_tickets (int tickets);
+bool thread_set_realtime (int64_t runtime, int64_t period);
 //int count[3];->userprog에서 error
 
 
@@ -0,0 +1,213 @@
+#include "threads/trace.h"
+#ifdef SCHED_TRACE
+#include <debug.h>
+#include <inttypes.h>
+#include <round.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/block.h"
+#include "devices/timer.h"
+#include "threads/cpu.h"
+#include "threads/interrupt.h"
+#include "threads/palloc.h"
+#include "threads/vaddr.h"
+
+/* Number of events in the ring.  Must be a power of 2. */
+#define TRACE_EVENTS 4096
+
+/* Ring of the last TRACE_EVENTS events, indexed by sequence
+   number modulo TRACE_EVENTS.  Null until trace_init() and while
+   the ring is being dumped, which turns recording off. */
+static struct trace_event *ring;
+
+/* Sequence number of the next event. */
+static uint32_t next_seq;
+
+/* Where to dump the ring, or a null pointer not to. */
+static const char *output;
+
+/* Time-stamp counter and timer ticks when tracing started, for
+   measuring the TSC frequency. */
+static uint64_t start_tsc;
+static int64_t start_ticks;
+
+static void dump_serial (const struct trace_header *,
+                         const struct trace_event *, uint32_t first);
+static void dump_block (struct block *, struct trace_header *,
+                        const struct trace_event *, uint32_t first);
+
+/* Allocates the trace ring and starts recording.  Events traced
+   before this are dropped. */
+void
+trace_init (void)
+{
+  size_t page_cnt = DIV_ROUND_UP (TRACE_EVENTS * sizeof *ring, PGSIZE);
+
+  start_tsc = rdtsc ();
+  start_ticks = timer_ticks ();
+  ring = palloc_get_multiple (PAL_ASSERT | PAL_ZERO, page_cnt);
+}
+
+/* Makes trace_dump() write to DEST, which is "serial" or the
+   name of a block device. */
+void
+trace_set_output (const char *dest)
+{
+  output = dest;
+}
+
+/* Records an event of the given TYPE concerning thread TID, with
+   type-specific argument ARG.  Interrupts must be off. */
+void
+trace_record (enum trace_type type, int tid, int arg)
+{
+  struct trace_event *e;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (ring == NULL)
+    return;
+  e = &ring[next_seq & (TRACE_EVENTS - 1)];
+  e->tsc = rdtsc ();
+  e->seq = next_seq++;
+  e->type = type;
+  e->tid = tid;
+  e->arg = arg;
+}
+
+/* Stops recording and dumps the ring to the device selected by
+   trace_set_output(), if any. */
+void
+trace_dump (void)
+{
+  struct trace_event *events;
+  struct trace_header h;
+  enum intr_level old_level;
+  int64_t ticks;
+
+  if (ring == NULL || output == NULL)
+    return;
+
+  old_level = intr_disable ();
+  events = ring;
+  ring = NULL;
+  intr_set_level (old_level);
+
+  memset (&h, 0, sizeof h);
+  h.magic = TRACE_MAGIC;
+  h.event_size = sizeof (struct trace_event);
+  h.event_cnt = next_seq < TRACE_EVENTS ? next_seq : TRACE_EVENTS;
+  h.dropped = next_seq - h.event_cnt;
+  ticks = timer_ticks () - start_ticks;
+  h.tsc_per_tick = ticks > 0 ? (rdtsc () - start_tsc) / ticks : 0;
+  h.timer_freq = TIMER_FREQ;
+
+  if (!strcmp (output, "serial"))
+    dump_serial (&h, events, h.dropped);
+  else
+    {
+      struct block *block = (!strcmp (output, "scratch")
+                             ? block_get_role (BLOCK_SCRATCH)
+                             : block_get_by_name (output));
+      if (block == NULL)
+        printf ("trace dump: no block device \"%s\"\n", output);
+      else if (intr_get_level () == INTR_OFF)
+        printf ("trace dump: interrupts off, cannot write to %s\n",
+                output);
+      else
+        dump_block (block, &h, events, h.dropped);
+    }
+}
+
+/* Prints SIZE bytes at BUF as a "trace:" line of hex digits. */
+static void
+print_hex_line (const void *buf_, size_t size)
+{
+  const uint8_t *buf = buf_;
+  size_t i;
+
+  printf ("trace: ");
+  for (i = 0; i < size; i++)
+    printf ("%02x", buf[i]);
+  printf ("\n");
+}
+
+/* Writes header H and the events in EVENTS, starting from
+   sequence number FIRST, to the console, one per line. */
+static void
+dump_serial (const struct trace_header *h, const struct trace_event *events,
+             uint32_t first)
+{
+  uint32_t i;
+
+  print_hex_line (h, sizeof *h);
+  for (i = 0; i < h->event_cnt; i++)
+    print_hex_line (&events[(first + i) & (TRACE_EVENTS - 1)],
+                    sizeof *events);
+}
+
+/* Writes header H to sector 0 of BLOCK and the events in EVENTS,
+   starting from sequence number FIRST, to the following sectors.
+   Drops the oldest events if BLOCK is too small for all of
+   them. */
+static void
+dump_block (struct block *block, struct trace_header *h,
+            const struct trace_event *events, uint32_t first)
+{
+  static uint8_t sector[BLOCK_SECTOR_SIZE];
+  block_sector_t sector_cnt = block_size (block);
+  uint32_t max_events, i;
+  block_sector_t sec;
+  size_t ofs;
+
+  if (sector_cnt < 2)
+    {
+      printf ("trace dump: %s is too small\n", block_name (block));
+      return;
+    }
+  max_events = (sector_cnt - 1) * BLOCK_SECTOR_SIZE / sizeof *events;
+  if (h->event_cnt > max_events)
+    {
+      first += h->event_cnt - max_events;
+      h->dropped += h->event_cnt - max_events;
+      h->event_cnt = max_events;
+    }
+
+  memset (sector, 0, sizeof sector);
+  memcpy (sector, h, sizeof *h);
+  block_write (block, 0, sector);
+
+  /* Events may straddle sector boundaries. */
+  sec = 1;
+  ofs = 0;
+  for (i = 0; i < h->event_cnt; i++)
+    {
+      const uint8_t *e = (const uint8_t *)
+        &events[(first + i) & (TRACE_EVENTS - 1)];
+      size_t left = sizeof *events;
+
+      while (left > 0)
+        {
+          size_t chunk = BLOCK_SECTOR_SIZE - ofs;
+          if (chunk > left)
+            chunk = left;
+          memcpy (sector + ofs, e, chunk);
+          e += chunk;
+          left -= chunk;
+          ofs += chunk;
+          if (ofs == BLOCK_SECTOR_SIZE)
+            {
+              block_write (block, sec++, sector);
+              ofs = 0;
+            }
+        }
+    }
+  if (ofs > 0)
+    {
+      memset (sector + ofs, 0, BLOCK_SECTOR_SIZE - ofs);
+      block_write (block, sec, sector);
+    }
+  printf ("trace dump: %"PRIu32" events written to %s\n",
+          h->event_cnt, block_name (block));
+}
+#endif /* SCHED_TRACE */
@@ -0,0 +1,76 @@
+#ifndef THREADS_TRACE_H
+#define THREADS_TRACE_H
+
+/* Scheduler event trace.
+
+   When the kernel is built with SCHED_TRACE defined (run "make
+   SCHED_TRACE=1"), the scheduler records context switches,
+   wakeups, blocks, lottery draws, and sleeps in a fixed-size ring
+   buffer, each with a time-stamp counter reading.  Recording an
+   event takes a few stores and no locks, because every trace
+   point runs with interrupts off.  Without SCHED_TRACE, the
+   TRACE macro expands to nothing.
+
+   With the "-trace=DEST" kernel command-line option, the ring is
+   dumped at power-off, oldest event first.  DEST is "serial", to
+   write the dump as hex text lines to the console, or the name
+   of a block device ("scratch" selects the scratch device), to
+   write it there in binary.  Either form is decoded on the host
+   by utils/pintos-trace.
+
+   This header is also included by the host decoder, so it
+   defines the dump format using only <stdint.h> types. */
+
+#include <stdint.h>
+
+/* Event types. */
+enum trace_type
+  {
+    TRACE_SWITCH,               /* TID switched to thread ARG. */
+    TRACE_WAKEUP,               /* TID became ready. */
+    TRACE_BLOCK,                /* TID blocked. */
+    TRACE_LOTTERY,              /* TID won a draw from ARG tickets. */
+    TRACE_SLEEP,                /* TID sleeps until tick ARG. */
+    TRACE_AWAKE,                /* TID woke at tick ARG. */
+    TRACE_TYPE_CNT
+  };
+
+/* A traced event. */
+struct trace_event
+  {
+    uint64_t tsc;               /* Time-stamp counter. */
+    uint32_t seq;               /* Sequence number since boot. */
+    uint32_t type;              /* An enum trace_type. */
+    int32_t tid;                /* Thread the event concerns. */
+    int32_t arg;                /* Type-specific argument. */
+  };
+
+/* Header of a dump, followed by EVENT_CNT events, oldest first.
+   In a block device dump, the header takes all of sector 0 and
+   the events begin in sector 1. */
+struct trace_header
+  {
+    uint32_t magic;             /* TRACE_MAGIC. */
+    uint32_t event_size;        /* sizeof (struct trace_event). */
+    uint32_t event_cnt;         /* Number of events in the dump. */
+    uint32_t dropped;           /* Older events overwritten. */
+    uint64_t tsc_per_tick;      /* Measured TSC cycles per timer tick. */
+    uint32_t timer_freq;        /* Timer ticks per second. */
+    uint32_t reserved;          /* Must be zero. */
+  };
+
+/* "PTRC" in little-endian byte order. */
+#define TRACE_MAGIC 0x43525450
+
+#ifdef SCHED_TRACE
+void trace_init (void);
+void trace_set_output (const char *dest);
+void trace_record (enum trace_type, int tid, int arg);
+void trace_dump (void);
+
+#define TRACE(TYPE, TID, ARG) trace_record (TYPE, TID, ARG)
+#else
+#define TRACE(TYPE, TID, ARG) ((void) 0)
+#endif
+
+#endif /* threads/trace.h */
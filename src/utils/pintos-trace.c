@@ -0,0 +1,197 @@
+#include <ctype.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "threads/trace.h"
+
+/* Decodes a Pintos scheduler trace dump (see threads/trace.h).
+
+   The input is either an image of the block device the dump was
+   written to, in which the dump header is found by scanning for
+   TRACE_MAGIC at the start of each sector, or a console log
+   containing the "trace:" lines written by "-trace=serial". */
+
+#define SECTOR_SIZE 512
+
+static const char *program_name;
+
+/* Names of the event types. */
+static const char *type_names[TRACE_TYPE_CNT] =
+  {
+    "switch", "wakeup", "block", "lottery", "sleep", "awake",
+  };
+
+/* Prints a message to stderr and exits. */
+static void
+fail (const char *message, const char *arg)
+{
+  fprintf (stderr, "%s: %s%s%s\n", program_name, message,
+           arg != NULL ? ": " : "", arg != NULL ? arg : "");
+  exit (EXIT_FAILURE);
+}
+
+/* Reads all of FILE into memory.  Returns the data and stores its
+   size in *SIZE. */
+static uint8_t *
+read_file (FILE *file, size_t *size)
+{
+  size_t capacity = 65536;
+  uint8_t *data = malloc (capacity);
+  size_t n;
+
+  *size = 0;
+  while (data != NULL
+         && (n = fread (data + *size, 1, capacity - *size, file)) > 0)
+    {
+      *size += n;
+      if (*size == capacity)
+        data = realloc (data, capacity *= 2);
+    }
+  if (data == NULL)
+    fail ("out of memory", NULL);
+  return data;
+}
+
+/* Converts the "trace:" lines in the SIZE bytes of text at TEXT
+   back to binary, in place.  Returns the number of bytes of
+   binary data. */
+static size_t
+decode_hex_lines (uint8_t *text, size_t size)
+{
+  static const char prefix[] = "trace: ";
+  size_t out = 0;
+  size_t pos = 0;
+
+  while (pos < size)
+    {
+      size_t end = pos;
+      while (end < size && text[end] != '\n')
+        end++;
+
+      if (end - pos >= sizeof prefix - 1
+          && !memcmp (text + pos, prefix, sizeof prefix - 1))
+        {
+          size_t i = pos + sizeof prefix - 1;
+          while (i + 1 < end && isxdigit (text[i]) && isxdigit (text[i + 1]))
+            {
+              char hex[3] = { text[i], text[i + 1], '\0' };
+              text[out++] = strtoul (hex, NULL, 16);
+              i += 2;
+            }
+        }
+      pos = end + 1;
+    }
+  return out;
+}
+
+/* Prints the dump whose header is H and whose events follow at
+   EVENTS. */
+static void
+print_dump (const struct trace_header *h, const uint8_t *events)
+{
+  double cycles_per_us = 0.0;
+  uint64_t first_tsc = 0;
+  uint32_t i;
+
+  if (h->tsc_per_tick != 0 && h->timer_freq != 0)
+    cycles_per_us = (double) h->tsc_per_tick * h->timer_freq / 1e6;
+
+  printf ("%u events, %u older events dropped, %llu cycles per tick\n",
+          h->event_cnt, h->dropped, (unsigned long long) h->tsc_per_tick);
+  for (i = 0; i < h->event_cnt; i++)
+    {
+      struct trace_event e;
+      const char *name;
+
+      memcpy (&e, events + (size_t) i * h->event_size, sizeof e);
+      if (i == 0)
+        first_tsc = e.tsc;
+      name = e.type < TRACE_TYPE_CNT ? type_names[e.type] : "?";
+
+      if (cycles_per_us > 0.0)
+        printf ("%12.1f us", (e.tsc - first_tsc) / cycles_per_us);
+      else
+        printf ("%14llu", (unsigned long long) (e.tsc - first_tsc));
+      printf (" %10u %-8s tid %d", e.seq, name, e.tid);
+      switch (e.type)
+        {
+        case TRACE_SWITCH:
+          printf (" -> tid %d", e.arg);
+          break;
+        case TRACE_LOTTERY:
+          printf (" of %d tickets", e.arg);
+          break;
+        case TRACE_SLEEP:
+        case TRACE_AWAKE:
+          printf (" at tick %d", e.arg);
+          break;
+        }
+      printf ("\n");
+    }
+}
+
+/* Returns true if H looks like a dump header whose events,
+   starting at offset EVENTS_OFS, fit within SIZE bytes of input. */
+static bool
+valid_header (const struct trace_header *h, size_t size, size_t events_ofs)
+{
+  return (h->magic == TRACE_MAGIC
+          && h->event_size >= sizeof (struct trace_event)
+          && events_ofs + (uint64_t) h->event_cnt * h->event_size <= size);
+}
+
+int
+main (int argc, char *argv[])
+{
+  struct trace_header h;
+  uint8_t *data;
+  size_t size, ofs;
+  FILE *file;
+
+  program_name = argv[0];
+  if (argc != 2)
+    {
+      fprintf (stderr,
+               "pintos-trace: decodes a Pintos scheduler trace dump\n"
+               "usage: %s FILE\n"
+               "  where FILE is a disk image written by -trace=BDEV\n"
+               "    or a console log written by -trace=serial.\n",
+               program_name);
+      return EXIT_FAILURE;
+    }
+
+  file = fopen (argv[1], "rb");
+  if (file == NULL)
+    fail (strerror (errno), argv[1]);
+  data = read_file (file, &size);
+  fclose (file);
+
+  /* Binary dump on a block device. */
+  for (ofs = 0; ofs + SECTOR_SIZE <= size; ofs += SECTOR_SIZE)
+    {
+      memcpy (&h, data + ofs, sizeof h);
+      if (valid_header (&h, size, ofs + SECTOR_SIZE))
+        {
+          print_dump (&h, data + ofs + SECTOR_SIZE);
+          return EXIT_SUCCESS;
+        }
+    }
+
+  /* Hex dump in a console log. */
+  size = decode_hex_lines (data, size);
+  if (size >= sizeof h)
+    {
+      memcpy (&h, data, sizeof h);
+      if (valid_header (&h, size, sizeof h))
+        {
+          print_dump (&h, data + sizeof h);
+          return EXIT_SUCCESS;
+        }
+    }
+
+  fail ("no trace dump found", argv[1]);
+  return EXIT_FAILURE;
+}